@@ -2,12 +2,21 @@
 
 set -e
 
-make clean
-make
-clear
-
 MODE=${1:-"gui"}
 
+# Console mode builds the headless profile (no framebuffer or keyboard)
+if [ "$MODE" == "gui" ]; then
+    CONFIG=default
+    KERNEL=build/spark.bin
+else
+    CONFIG=headless
+    KERNEL=build/headless/spark.bin
+fi
+
+make clean CONFIG=$CONFIG
+make CONFIG=$CONFIG
+clear
+
 # Create disk image if it doesn't exist
 DISK_IMG="disk.img"
 if [ ! -f "$DISK_IMG" ]; then
@@ -18,6 +27,9 @@ fi
 # Use SD controller so the PL181 driver can access the disk
 DRIVE_IF="sd"
 
+# Kernel command line, e.g. APPEND="cache=64" ./BuildKernel.sh
+APPEND="${APPEND:-}"
+
 if [ "$MODE" == "gui" ]; then
     qemu-system-arm \
         -M versatilepb \
@@ -27,7 +39,8 @@ if [ "$MODE" == "gui" ]; then
         -net user \
         -drive file=$DISK_IMG,format=raw,if=${DRIVE_IF} \
         -serial stdio \
-        -kernel build/spark.bin
+        -kernel $KERNEL \
+        -append "$APPEND"
 else
     # Console mode (no graphics)
     qemu-system-arm \
@@ -38,5 +51,6 @@ else
         -net nic,model=smc91c111 \
         -net user \
         -drive file=$DISK_IMG,format=raw,if=${DRIVE_IF} \
-        -kernel build/spark.bin
+        -kernel $KERNEL \
+        -append "$APPEND"
 fi
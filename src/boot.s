@@ -1,7 +1,34 @@
 .global _start
 .section .text
 _start:
+    @ Keep the bootloader's r0 (0), r1 (machine type) and r2 (ATAG list)
+    mov r4, r0
+    mov r5, r1
+    mov r6, r2
+
+    @ IRQ mode stack (only used briefly by the IRQ entry code)
+    msr cpsr_c, #0xD2
+    ldr sp, =irq_stack_top
+
+    @ SVC mode with interrupts masked until the scheduler is up
+    msr cpsr_c, #0xD3
     ldr sp, =stack_top
+
+    @ Install the exception vectors at 0x0 (they end well below the ATAG
+    @ list, which the loader puts at 0x100)
+    ldr r0, =vectors_start
+    ldr r1, =vectors_end
+    mov r2, #0
+1:
+    ldr r3, [r0], #4
+    str r3, [r2], #4
+    cmp r0, r1
+    blo 1b
+
+    @ kernel_main(r0, machine, atags)
+    mov r0, r4
+    mov r1, r5
+    mov r2, r6
     bl kernel_main
 
 halt:
@@ -12,3 +39,6 @@ halt:
 stack:
     .space 0x10000
 stack_top:
+irq_stack:
+    .space 0x400
+irq_stack_top:
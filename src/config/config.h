@@ -0,0 +1,57 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/*
+ * Build configuration
+ *
+ * The Makefile force-includes src/config/$(CONFIG).h ahead of every source
+ * (make CONFIG=headless). A profile only defines what it changes and then
+ * includes this file, which fills in the defaults. Feature switches are 0
+ * or 1 so they can be tested with #if.
+ */
+
+// Features
+#ifndef CONFIG_GRAPHICS
+#define CONFIG_GRAPHICS             1       // PL110 console mirror
+#endif
+
+#ifndef CONFIG_PS2
+#define CONFIG_PS2                  1       // KMI keyboard
+#endif
+
+#ifndef CONFIG_VI
+#define CONFIG_VI                   1       // vi editor
+#endif
+
+#ifndef CONFIG_SETUP
+#define CONFIG_SETUP                1       // setup wizard
+#endif
+
+#ifndef CONFIG_HUD
+#define CONFIG_HUD                  1       // Status row (needs graphics)
+#endif
+
+// Buffer and cache sizes
+#ifndef CONFIG_UART_TX_SIZE
+#define CONFIG_UART_TX_SIZE         4096    // Power of two
+#endif
+
+#ifndef CONFIG_UART_RX_SIZE
+#define CONFIG_UART_RX_SIZE         1024    // Power of two
+#endif
+
+#ifndef CONFIG_KLOG_SIZE
+#define CONFIG_KLOG_SIZE            4096    // Power of two
+#endif
+
+#ifndef CONFIG_FAT_CACHE_SECTORS
+#define CONFIG_FAT_CACHE_SECTORS    32      // 512 bytes each; 0 disables
+#endif
+
+// Grow the sector cache past CONFIG_FAT_CACHE_SECTORS on boards with more
+// RAM; the `cache=` boot option overrides either way
+#ifndef CONFIG_FAT_CACHE_SCALE
+#define CONFIG_FAT_CACHE_SCALE      1
+#endif
+
+#endif
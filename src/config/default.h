@@ -0,0 +1,5 @@
+/*
+ * Default profile: everything on (see config.h)
+ */
+
+#include "config.h"
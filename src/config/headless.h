@@ -0,0 +1,11 @@
+/*
+ * Headless profile: serial console only
+ *
+ * No framebuffer or keyboard, so console output goes straight to the
+ * UART without the ANSI parser or glyph renderer behind it.
+ */
+
+#define CONFIG_GRAPHICS             0
+#define CONFIG_PS2                  0
+
+#include "config.h"
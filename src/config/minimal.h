@@ -0,0 +1,17 @@
+/*
+ * Minimal profile: headless, without the interactive programs, and with
+ * small buffers
+ */
+
+#define CONFIG_GRAPHICS             0
+#define CONFIG_PS2                  0
+#define CONFIG_VI                   0
+#define CONFIG_SETUP                0
+
+#define CONFIG_UART_TX_SIZE         1024
+#define CONFIG_UART_RX_SIZE         256
+#define CONFIG_KLOG_SIZE            1024
+#define CONFIG_FAT_CACHE_SECTORS    8
+#define CONFIG_FAT_CACHE_SCALE      0
+
+#include "config.h"
@@ -0,0 +1,1156 @@
+/*
+ * FAT32 File System Driver for Spark Kernel
+ */
+
+#include "fat32Driver.h"
+#include <sys/coroutine.h>
+#include <sys/heap.h>
+#include <sys/irq.h>
+#include <sys/klog.h>
+#include <sys/thread.h>
+
+// ============================================================================
+// Global FAT32 State
+// ============================================================================
+
+fat32_fs_t g_fat32_fs = {0};
+u8 g_sector_buffer[FAT32_SECTOR_SIZE] = {0};
+u8 g_cluster_buffer[FAT32_MAX_CLUSTER_SIZE];
+fat32_discard_queue_t g_fat32_discard = {0};
+
+// ============================================================================
+// Platform-Specific Disk Implementation
+// ============================================================================
+
+/*
+ * For VersatilePB/QEMU, we can use:
+ * 1. PL181 SD Card Controller (MMCI)
+ * 2. Memory-mapped disk image
+ *
+ * This implementation uses a simple memory-mapped approach for QEMU
+ * where a disk image can be loaded at a fixed address.
+ */
+
+// Memory-mapped disk base address (configurable)
+#define DISK_BASE_ADDR      0x10000000  // Adjust based on your setup
+
+// Simple memory-mapped disk read (for QEMU with -drive file=disk.img,if=pflash)
+// Runtime-determined memory base for the disk image. Initialize to default.
+static volatile u8 *fat32_mem_base = (volatile u8 *)DISK_BASE_ADDR;
+
+// ============================================================================
+// Filesystem Ownership
+// ============================================================================
+
+// SD transfers yield, so a coroutine or thread can be switched out in the
+// middle of a FAT update (between finding a free cluster and claiming it,
+// or with g_sector_buffer half used). Every public call that touches the
+// volume holds the filesystem for its whole length. Calls nest: the owner
+// (a coroutine, or else a thread) may claim it again.
+
+static void *fat32_owner = 0;
+static u32 fat32_depth = 0;
+
+static void *fat32_self(void) {
+    co_t *co = co_self();
+    return co ? (void *)co : (void *)thread_current();
+}
+
+static int fat32_free(void *arg) {
+    (void)arg;
+    return fat32_depth == 0;
+}
+
+void fat32_claim(void) {
+    void *self = fat32_self();
+    while (1) {
+        u32 flags = irq_save();
+        if (fat32_depth == 0 || fat32_owner == self) {
+            fat32_owner = self;
+            fat32_depth++;
+            irq_restore(flags);
+            return;
+        }
+        irq_restore(flags);
+        co_await_io(fat32_free, 0);
+    }
+}
+
+void fat32_release(void) {
+    u32 flags = irq_save();
+    if (--fat32_depth == 0) fat32_owner = 0;
+    irq_restore(flags);
+}
+
+// ============================================================================
+// Sector Cache
+// ============================================================================
+
+/*
+ * FAT entries and directory sectors are read one sector at a time and over
+ * and over (every cluster hop re-reads its FAT sector), so single-sector
+ * reads are served from a small LRU cache. Writes go straight to the card
+ * and refresh any cached copy, so the cache never holds unwritten data.
+ */
+static u32 fat32_cache_hits = 0;
+static u32 fat32_cache_misses = 0;
+
+#if CONFIG_FAT_CACHE_SECTORS > 0
+#define FAT32_CACHE_NONE    0xFFFF
+#define FAT32_CACHE_BUCKETS 64          // Power of two
+
+typedef struct {
+    u32 lba;
+    u16 valid;
+    u16 hash_next;                  // Next slot in the same bucket
+    u16 newer;                      // LRU list neighbours
+    u16 older;
+    u8 data[FAT32_SECTOR_SIZE];
+} fat32_cache_slot_t;
+
+// Starts out in the image; fat32_cache_init() moves it to the heap when
+// the board has room for more
+static fat32_cache_slot_t fat32_cache_static[CONFIG_FAT_CACHE_SECTORS];
+static fat32_cache_slot_t *fat32_cache = fat32_cache_static;
+static u32 fat32_cache_capacity = CONFIG_FAT_CACHE_SECTORS;
+static u32 fat32_cache_slots = 0;   // Slots in use; 0 until the first reset
+
+// Valid slots hang off a bucket picked by the low LBA bits (FAT and
+// directory sectors are runs of consecutive LBAs, so they spread evenly).
+// Every slot in use sits on one LRU list; empty ones are kept at the old
+// end so they are reused first.
+static u16 fat32_cache_buckets[FAT32_CACHE_BUCKETS];
+static u16 fat32_cache_newest = FAT32_CACHE_NONE;
+static u16 fat32_cache_oldest = FAT32_CACHE_NONE;
+
+static void fat32_cache_unlink(u16 i) {
+    fat32_cache_slot_t *slot = &fat32_cache[i];
+    if (slot->newer != FAT32_CACHE_NONE) fat32_cache[slot->newer].older = slot->older;
+    else fat32_cache_newest = slot->older;
+    if (slot->older != FAT32_CACHE_NONE) fat32_cache[slot->older].newer = slot->newer;
+    else fat32_cache_oldest = slot->newer;
+}
+
+static void fat32_cache_push_newest(u16 i) {
+    fat32_cache[i].newer = FAT32_CACHE_NONE;
+    fat32_cache[i].older = fat32_cache_newest;
+    if (fat32_cache_newest != FAT32_CACHE_NONE) fat32_cache[fat32_cache_newest].newer = i;
+    else fat32_cache_oldest = i;
+    fat32_cache_newest = i;
+}
+
+static void fat32_cache_push_oldest(u16 i) {
+    fat32_cache[i].older = FAT32_CACHE_NONE;
+    fat32_cache[i].newer = fat32_cache_oldest;
+    if (fat32_cache_oldest != FAT32_CACHE_NONE) fat32_cache[fat32_cache_oldest].older = i;
+    else fat32_cache_newest = i;
+    fat32_cache_oldest = i;
+}
+
+static fat32_cache_slot_t *fat32_cache_find(u32 lba) {
+    u16 i = fat32_cache_buckets[lba & (FAT32_CACHE_BUCKETS - 1)];
+    while (i != FAT32_CACHE_NONE) {
+        if (fat32_cache[i].lba == lba) return &fat32_cache[i];
+        i = fat32_cache[i].hash_next;
+    }
+    return 0;
+}
+
+static void fat32_cache_insert(fat32_cache_slot_t *slot, u32 lba) {
+    u16 *bucket = &fat32_cache_buckets[lba & (FAT32_CACHE_BUCKETS - 1)];
+    slot->lba = lba;
+    slot->valid = 1;
+    slot->hash_next = *bucket;
+    *bucket = (u16)(slot - fat32_cache);
+}
+
+// Take a slot out of its bucket and move it to the old end of the list
+static void fat32_cache_drop(fat32_cache_slot_t *slot) {
+    u16 i = (u16)(slot - fat32_cache);
+    if (!slot->valid) return;
+
+    u16 *link = &fat32_cache_buckets[slot->lba & (FAT32_CACHE_BUCKETS - 1)];
+    while (*link != i) link = &fat32_cache[*link].hash_next;
+    *link = slot->hash_next;
+    slot->valid = 0;
+
+    fat32_cache_unlink(i);
+    fat32_cache_push_oldest(i);
+}
+
+static void fat32_cache_touch(fat32_cache_slot_t *slot) {
+    u16 i = (u16)(slot - fat32_cache);
+    if (i == fat32_cache_newest) return;
+    fat32_cache_unlink(i);
+    fat32_cache_push_newest(i);
+}
+
+// Empty every slot and use the first `sectors` of them
+static void fat32_cache_reset(u32 sectors) {
+    for (u32 i = 0; i < FAT32_CACHE_BUCKETS; i++) {
+        fat32_cache_buckets[i] = FAT32_CACHE_NONE;
+    }
+    fat32_cache_newest = FAT32_CACHE_NONE;
+    fat32_cache_oldest = FAT32_CACHE_NONE;
+    for (u32 i = 0; i < sectors; i++) {
+        fat32_cache[i].valid = 0;
+        fat32_cache_push_oldest((u16)i);
+    }
+    fat32_cache_slots = sectors;
+}
+#endif
+
+static void fat32_cache_invalidate_claimed(u32 lba, u32 count) {
+#if CONFIG_FAT_CACHE_SECTORS > 0
+    if (count <= fat32_cache_slots) {
+        for (u32 n = 0; n < count; n++) {
+            fat32_cache_slot_t *slot = fat32_cache_find(lba + n);
+            if (slot) fat32_cache_drop(slot);
+        }
+        return;
+    }
+    for (u32 i = 0; i < fat32_cache_slots; i++) {
+        if (fat32_cache[i].lba - lba < count) {
+            fat32_cache_drop(&fat32_cache[i]);
+        }
+    }
+#else
+    (void)lba;
+    (void)count;
+#endif
+}
+
+void fat32_cache_invalidate(u32 lba, u32 count) {
+    fat32_claim();
+    fat32_cache_invalidate_claimed(lba, count);
+    fat32_release();
+}
+
+// Size the cache to `sectors` slots, taking them from the heap when the
+// CONFIG_FAT_CACHE_SECTORS in the image are not enough
+// Returns the size in effect
+u32 fat32_cache_init(u32 sectors) {
+#if CONFIG_FAT_CACHE_SECTORS > 0
+    if (sectors > FAT32_CACHE_MAX_SECTORS) sectors = FAT32_CACHE_MAX_SECTORS;
+    if (sectors > fat32_cache_capacity) {
+        fat32_cache_slot_t *slots = kalloc(sectors * sizeof(fat32_cache_slot_t), 4);
+        if (slots) {
+            memset(slots, 0, sectors * sizeof(fat32_cache_slot_t));
+            fat32_cache = slots;
+            fat32_cache_capacity = sectors;
+        }
+    }
+    return fat32_cache_set_size(sectors);
+#else
+    (void)sectors;
+    return 0;
+#endif
+}
+
+// Use only the first `sectors` slots of what fat32_cache_init() allocated
+// Returns the size in effect
+static u32 fat32_cache_set_size_claimed(u32 sectors) {
+#if CONFIG_FAT_CACHE_SECTORS > 0
+    if (sectors > fat32_cache_capacity) sectors = fat32_cache_capacity;
+    fat32_cache_reset(sectors);
+    return sectors;
+#else
+    (void)sectors;
+    return 0;
+#endif
+}
+
+u32 fat32_cache_set_size(u32 sectors) {
+    fat32_claim();
+    u32 result = fat32_cache_set_size_claimed(sectors);
+    fat32_release();
+    return result;
+}
+
+void fat32_cache_stats(u32 *hits, u32 *misses) {
+    *hits = fat32_cache_hits;
+    *misses = fat32_cache_misses;
+}
+
+static int fat32_disk_read_sectors_claimed(u32 lba, u32 count, void *buffer) {
+#if CONFIG_FAT_CACHE_SECTORS > 0
+    if (count == 1 && fat32_cache_slots > 0) {
+        fat32_cache_slot_t *slot = fat32_cache_find(lba);
+        if (slot) {
+            fat32_cache_hits++;
+        } else {
+            fat32_cache_misses++;
+            slot = &fat32_cache[fat32_cache_oldest];
+            fat32_cache_drop(slot);
+            if (sd_read_sectors(lba, 1, slot->data) != 0) {
+                return -1;
+            }
+            fat32_cache_insert(slot, lba);
+        }
+        fat32_cache_touch(slot);
+        memcpy(buffer, slot->data, FAT32_SECTOR_SIZE);
+        return 0;
+    }
+#endif
+
+    // Use PL181 SD controller for block reads
+    return sd_read_sectors(lba, count, buffer);
+}
+
+int fat32_disk_read_sectors(u32 lba, u32 count, void *buffer) {
+    fat32_claim();
+    int result = fat32_disk_read_sectors_claimed(lba, count, buffer);
+    fat32_release();
+    return result;
+}
+
+static int fat32_disk_write_sectors_claimed(u32 lba, u32 count, const void *buffer) {
+    // Use PL181 SD controller for block writes
+    int result = sd_write_sectors(lba, count, buffer);
+
+#if CONFIG_FAT_CACHE_SECTORS > 0
+    // Keep cached copies in step; after a failed write the card's
+    // contents are unknown, so drop them instead
+    if (result != 0) {
+        fat32_cache_invalidate_claimed(lba, count);
+    } else if (fat32_cache_slots > 0) {
+        for (u32 n = 0; n < count; n++) {
+            fat32_cache_slot_t *slot = fat32_cache_find(lba + n);
+            if (slot) {
+                memcpy(slot->data, (const u8 *)buffer + n * FAT32_SECTOR_SIZE,
+                       FAT32_SECTOR_SIZE);
+            }
+        }
+    }
+#endif
+
+    return result;
+}
+
+int fat32_disk_write_sectors(u32 lba, u32 count, const void *buffer) {
+    fat32_claim();
+    int result = fat32_disk_write_sectors_claimed(lba, count, buffer);
+    fat32_release();
+    return result;
+}
+
+// Probe a memory address to see if it contains a valid FAT32 boot sector.
+static int fat32_probe_memory_base(u32 addr) {
+    volatile u8 *mem = (volatile u8 *)addr;
+    // Read first sector into temporary buffer
+    for (u32 i = 0; i < FAT32_SECTOR_SIZE; i++) {
+        g_sector_buffer[i] = mem[i];
+    }
+    // Check boot signature
+    if (g_sector_buffer[510] == 0x55 && g_sector_buffer[511] == 0xAA) {
+        // Basic sanity: ensure FAT32-specific fields exist: bytes per sector non-zero
+        fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
+        if (bpb->bytes_per_sector == FAT32_SECTOR_SIZE || bpb->bytes_per_sector == 512) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Probe and set fat32_mem_base using the same candidate addresses used in fat32_init
+static void fat32_probe_and_set_base(void) {
+    u32 probe_addrs[] = {
+        0x10000000u,
+        0x0A000000u,
+        0x00A00000u,
+        0x00100000u,
+        0x00000000u,
+        0x20000000u,
+        0x40000000u,
+        0x08000000u,
+        (u32)DISK_BASE_ADDR
+    };
+    for (u32 i = 0; i < sizeof(probe_addrs)/sizeof(probe_addrs[0]); i++) {
+        u32 a = probe_addrs[i];
+        if (fat32_probe_memory_base(a)) {
+            fat32_mem_base = (volatile u8 *)a;
+            return;
+        }
+    }
+    // leave default if none found
+    fat32_mem_base = (volatile u8 *)DISK_BASE_ADDR;
+}
+
+// Read and parse MBR partition table (up to max_entries). Returns number of entries parsed (0-4),
+// or -1 on disk read failure. If no MBR found but valid FAT32 boot sector at LBA 0 (superfloppy),
+// returns 1 with start=0. Entries starting past the end of the card are dropped and sizes are
+// clamped to the card capacity.
+static int fat32_read_partitions_claimed(u8 *types, u8 *flags, u32 *starts, u32 *sizes, int max_entries) {
+    if (max_entries <= 0) return 0;
+
+    // Initialize SD card
+    if (sd_init() != 0) {
+        return -1;
+    }
+
+    if (sd_read_sectors(0, 1, g_sector_buffer) != 0) {
+        return -1;
+    }
+
+    // Check for valid boot signature
+    if (g_sector_buffer[510] != 0x55 || g_sector_buffer[511] != 0xAA) {
+        return -1;
+    }
+
+    u32 capacity = sd_get_capacity();
+    int found = 0;
+    // Partition table starts at offset 446, 4 entries x 16 bytes
+    for (int i = 0; i < 4 && found < max_entries; i++) {
+        int off = 446 + i * 16;
+        u8 boot_flag = g_sector_buffer[off + 0];
+        u8 part_type = g_sector_buffer[off + 4];
+        u32 start_lba = *(u32 *)&g_sector_buffer[off + 8];
+        u32 part_size = *(u32 *)&g_sector_buffer[off + 12];
+
+        // Skip partitions that do not fit on this card
+        if (start_lba >= capacity) {
+            continue;
+        }
+        if (part_size > capacity - start_lba) {
+            part_size = capacity - start_lba;
+        }
+
+        // Only include non-empty partition entries (type != 0)
+        if (part_type != 0) {
+            types[found] = part_type;
+            flags[found] = boot_flag;
+            starts[found] = start_lba;
+            sizes[found] = part_size;
+            found++;
+        }
+    }
+
+    // If no MBR partitions found, check if this is a superfloppy (FAT32 at LBA 0)
+    if (found == 0) {
+        fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
+        // Check if it looks like a FAT32 boot sector
+        if (bpb->fat_size_16 == 0 && bpb->fat_size_32 != 0 &&
+            (bpb->bytes_per_sector == 512 || bpb->bytes_per_sector == FAT32_SECTOR_SIZE)) {
+            // Superfloppy - FAT32 starts at LBA 0
+            types[0] = 0x0C;  // FAT32 LBA type
+            flags[0] = 0;
+            starts[0] = 0;
+            sizes[0] = bpb->total_sectors_32 < capacity ? bpb->total_sectors_32 : capacity;
+            found = 1;
+        }
+    }
+
+    return found;
+}
+
+int fat32_read_partitions(u8 *types, u8 *flags, u32 *starts, u32 *sizes, int max_entries) {
+    fat32_claim();
+    int result = fat32_read_partitions_claimed(types, flags, starts, sizes, max_entries);
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+// Read a FAT entry
+static u32 fat32_read_fat_entry_claimed(u32 cluster) {
+    u32 fat_offset = cluster * 4;
+    u32 fat_sector = g_fat32_fs.fat_start_lba + fat_offset / FAT32_SECTOR_SIZE;
+    u32 entry_offset = fat_offset % FAT32_SECTOR_SIZE;
+
+    if (fat32_disk_read_sectors(fat_sector, 1, g_sector_buffer) != 0) {
+        return FAT32_EOC;  // Error, treat as end of chain
+    }
+
+    u32 entry = *(u32 *)&g_sector_buffer[entry_offset];
+    return entry & 0x0FFFFFFF;  // Mask upper 4 bits
+}
+
+u32 fat32_read_fat_entry(u32 cluster) {
+    fat32_claim();
+    u32 result = fat32_read_fat_entry_claimed(cluster);
+    fat32_release();
+    return result;
+}
+
+// Write a FAT entry
+static int fat32_write_fat_entry_claimed(u32 cluster, u32 value) {
+    u32 fat_offset = cluster * 4;
+    u32 fat_sector = g_fat32_fs.fat_start_lba + fat_offset / FAT32_SECTOR_SIZE;
+    u32 entry_offset = fat_offset % FAT32_SECTOR_SIZE;
+
+    // Read current sector
+    if (fat32_disk_read_sectors(fat_sector, 1, g_sector_buffer) != 0) {
+        return -1;
+    }
+
+    // Modify entry (preserve upper 4 bits)
+    u32 *entry = (u32 *)&g_sector_buffer[entry_offset];
+    *entry = (*entry & 0xF0000000) | (value & 0x0FFFFFFF);
+
+    // Write back to all FATs
+    for (u8 i = 0; i < g_fat32_fs.num_fats; i++) {
+        u32 fat_lba = fat_sector + (i * g_fat32_fs.fat_size_sectors);
+        if (fat32_disk_write_sectors(fat_lba, 1, g_sector_buffer) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int fat32_write_fat_entry(u32 cluster, u32 value) {
+    fat32_claim();
+    int result = fat32_write_fat_entry_claimed(cluster, value);
+    fat32_release();
+    return result;
+}
+
+// Get next cluster in chain
+u32 fat32_next_cluster(u32 cluster) {
+    return fat32_read_fat_entry(cluster);
+}
+
+// Find a free cluster
+static u32 fat32_find_free_cluster_claimed(void) {
+    for (u32 cluster = 2; cluster < g_fat32_fs.total_clusters + 2; cluster++) {
+        if (fat32_read_fat_entry(cluster) == FAT32_FREE_CLUSTER) {
+            return cluster;
+        }
+    }
+    return 0;  // No free clusters
+}
+
+u32 fat32_find_free_cluster(void) {
+    fat32_claim();
+    u32 result = fat32_find_free_cluster_claimed();
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// String Helpers
+// ============================================================================
+
+// Convert character to uppercase
+static inline char fat32_toupper(char c) {
+    if (c >= 'a' && c <= 'z') {
+        return c - 32;
+    }
+    return c;
+}
+
+// Convert filename to 8.3 format
+int fat32_name_to_83(const char *name, u8 *name83) {
+    memset(name83, ' ', 11);
+
+    u32 len = strlen(name);
+    if (len == 0 || len > 12) return -1;
+
+    // Find the dot
+    int dot_pos = -1;
+    for (u32 i = 0; i < len; i++) {
+        if (name[i] == '.') {
+            dot_pos = i;
+            break;
+        }
+    }
+
+    // Copy name part (up to 8 chars)
+    int name_len = (dot_pos >= 0) ? dot_pos : (int)len;
+    if (name_len > 8) return -1;  // Name too long for 8.3
+
+    for (int i = 0; i < name_len; i++) {
+        name83[i] = fat32_toupper(name[i]);
+    }
+
+    // Copy extension (up to 3 chars)
+    if (dot_pos >= 0 && dot_pos < (int)len - 1) {
+        int ext_len = len - dot_pos - 1;
+        if (ext_len > 3) return -1;  // Extension too long
+
+        for (int i = 0; i < ext_len; i++) {
+            name83[8 + i] = fat32_toupper(name[dot_pos + 1 + i]);
+        }
+    }
+
+    return 0;
+}
+
+// Convert 8.3 format to readable name
+void fat32_83_to_name(const u8 *name83, char *name) {
+    int pos = 0;
+
+    // Copy name part (trimming spaces)
+    for (int i = 0; i < 8 && name83[i] != ' '; i++) {
+        name[pos++] = name83[i];
+    }
+
+    // Check if there's an extension
+    if (name83[8] != ' ') {
+        name[pos++] = '.';
+        for (int i = 8; i < 11 && name83[i] != ' '; i++) {
+            name[pos++] = name83[i];
+        }
+    }
+
+    name[pos] = '\0';
+}
+
+// ============================================================================
+// Core FAT32 Functions
+// ============================================================================
+
+// Initialize FAT32 filesystem
+static int fat32_init_claimed(u32 partition_start_lba) {
+    fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
+
+    // Initialize SD card first
+    if (sd_init() != 0) {
+        writeOut("[FAT32] SD card init failed\n");
+        return -1;
+    }
+    kprintf("[FAT32] SD card initialized (%u MB, %s)\n",
+            sd_get_capacity() >> 11, sd_is_high_capacity() ? "SDHC" : "SDSC");
+
+    // A fresh card may hold anything
+    fat32_cache_invalidate(0, 0xFFFFFFFF);
+
+    // Read boot sector using SD driver
+    if (fat32_disk_read_sectors(partition_start_lba, 1, g_sector_buffer) != 0) {
+        writeOut("[FAT32] Failed to read boot sector\n");
+        return -1;  // Disk read error
+    }
+
+    // Log the first bytes and boot signature to help diagnose mount failures
+    const u8 *b = g_sector_buffer;
+    klog("fat32: boot sector @%u: %02x %02x %02x %02x %02x %02x %02x %02x sig %02x%02x",
+         partition_start_lba, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], b[510], b[511]);
+
+    // Validate boot signature
+    if (g_sector_buffer[510] != 0x55 || g_sector_buffer[511] != 0xAA) {
+        return -2;  // Invalid boot signature
+    }
+
+    // Validate FAT32 (FAT size 16 should be 0, FAT size 32 should be non-zero)
+    if (bpb->fat_size_16 != 0 || bpb->fat_size_32 == 0) {
+        return -3;  // Not a FAT32 filesystem
+    }
+
+    // Sector and cluster sizes are powers of two on any valid FAT volume
+    u32 spc = bpb->sectors_per_cluster;
+    u32 bps = bpb->bytes_per_sector;
+    if (spc == 0 || (spc & (spc - 1)) != 0 || bps == 0 || (bps & (bps - 1)) != 0) {
+        return -3;
+    }
+
+    // The volume must fit on the card
+    u32 capacity = sd_get_capacity();
+    if (partition_start_lba >= capacity ||
+        bpb->total_sectors_32 > capacity - partition_start_lba) {
+        return -4;  // Filesystem larger than device
+    }
+
+    // Store filesystem parameters
+    g_fat32_fs.partition_start_lba = partition_start_lba;
+    g_fat32_fs.sectors_per_cluster = bpb->sectors_per_cluster;
+    g_fat32_fs.bytes_per_cluster = bpb->sectors_per_cluster * bpb->bytes_per_sector;
+    g_fat32_fs.spc_shift = __builtin_ctz(g_fat32_fs.sectors_per_cluster);
+    g_fat32_fs.cluster_shift = __builtin_ctz(g_fat32_fs.bytes_per_cluster);
+    g_fat32_fs.cluster_mask = g_fat32_fs.bytes_per_cluster - 1;
+    g_fat32_fs.num_fats = bpb->num_fats;
+    g_fat32_fs.fat_size_sectors = bpb->fat_size_32;
+    g_fat32_fs.root_cluster = bpb->root_cluster;
+    g_fat32_fs.total_sectors = bpb->total_sectors_32;
+
+    // Calculate LBA addresses
+    g_fat32_fs.fat_start_lba = partition_start_lba + bpb->reserved_sectors;
+    g_fat32_fs.data_start_lba = g_fat32_fs.fat_start_lba +
+                                 (bpb->num_fats * bpb->fat_size_32);
+
+    // Calculate total clusters
+    u32 data_sectors = bpb->total_sectors_32 -
+                       (bpb->reserved_sectors + bpb->num_fats * bpb->fat_size_32);
+    g_fat32_fs.total_clusters = data_sectors >> g_fat32_fs.spc_shift;
+
+    g_fat32_fs.initialized = 1;
+    klog("fat32: mounted @%u, %u clusters of %u bytes",
+         partition_start_lba, g_fat32_fs.total_clusters, g_fat32_fs.bytes_per_cluster);
+
+    return 0;  // Success
+}
+
+int fat32_init(u32 partition_start_lba) {
+    fat32_claim();
+    int result = fat32_init_claimed(partition_start_lba);
+    fat32_release();
+    return result;
+}
+
+// Check if FAT32 is initialized
+int fat32_is_initialized(void) {
+    return g_fat32_fs.initialized;
+}
+
+// Read a cluster into buffer
+static int fat32_read_cluster_claimed(u32 cluster, void *buffer) {
+    if (!g_fat32_fs.initialized) return -1;
+    if (cluster < 2) return -1;
+
+    u32 lba = fat32_cluster_to_lba(cluster);
+    return fat32_disk_read_sectors(lba, g_fat32_fs.sectors_per_cluster, buffer);
+}
+
+int fat32_read_cluster(u32 cluster, void *buffer) {
+    fat32_claim();
+    int result = fat32_read_cluster_claimed(cluster, buffer);
+    fat32_release();
+    return result;
+}
+
+// Write a cluster from buffer
+static int fat32_write_cluster_claimed(u32 cluster, const void *buffer) {
+    if (!g_fat32_fs.initialized) return -1;
+    if (cluster < 2) return -1;
+
+    u32 lba = fat32_cluster_to_lba(cluster);
+    return fat32_disk_write_sectors(lba, g_fat32_fs.sectors_per_cluster, buffer);
+}
+
+int fat32_write_cluster(u32 cluster, const void *buffer) {
+    fat32_claim();
+    int result = fat32_write_cluster_claimed(cluster, buffer);
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// Directory Operations
+// ============================================================================
+
+// Initialize directory iterator
+void fat32_dir_open(fat32_dir_iter_t *iter, u32 cluster) {
+    iter->cluster = cluster;
+    iter->entry_index = 0;
+    iter->sector_offset = 0;
+}
+
+// Open root directory
+void fat32_dir_open_root(fat32_dir_iter_t *iter) {
+    fat32_dir_open(iter, g_fat32_fs.root_cluster);
+}
+
+// Read next directory entry
+// Returns 0 if entry read, 1 if end of directory, -1 on error
+static int fat32_dir_read_claimed(fat32_dir_iter_t *iter, fat32_dir_entry_t *entry) {
+    if (!g_fat32_fs.initialized) return -1;
+
+    u8 cluster_buffer[FAT32_SECTOR_SIZE];
+    u32 entries_per_sector = FAT32_SECTOR_SIZE / sizeof(fat32_dir_entry_t);
+
+    while (1) {
+        // Check if we need to move to next cluster
+        u32 entries_per_cluster = g_fat32_fs.bytes_per_cluster / sizeof(fat32_dir_entry_t);
+        if (iter->entry_index >= entries_per_cluster) {
+            u32 next = fat32_next_cluster(iter->cluster);
+            if (fat32_is_eoc(next)) {
+                return 1;  // End of directory
+            }
+            iter->cluster = next;
+            iter->entry_index = 0;
+            iter->sector_offset = 0;
+        }
+
+        // Calculate which sector within the cluster
+        u32 sector_in_cluster = iter->entry_index / entries_per_sector;
+        u32 entry_in_sector = iter->entry_index % entries_per_sector;
+
+        // Read the sector
+        u32 lba = fat32_cluster_to_lba(iter->cluster) + sector_in_cluster;
+        if (fat32_disk_read_sectors(lba, 1, cluster_buffer) != 0) {
+            return -1;
+        }
+
+        fat32_dir_entry_t *dir_entry = (fat32_dir_entry_t *)cluster_buffer + entry_in_sector;
+        iter->entry_index++;
+
+        // Check for end of directory
+        if (dir_entry->name[0] == FAT32_DIR_ENTRY_END) {
+            return 1;
+        }
+
+        // Skip deleted entries
+        if (dir_entry->name[0] == FAT32_DIR_ENTRY_FREE) {
+            continue;
+        }
+
+        // Skip LFN entries
+        if ((dir_entry->attributes & FAT32_ATTR_LONG_NAME) == FAT32_ATTR_LONG_NAME) {
+            continue;
+        }
+
+        // Skip volume label
+        if (dir_entry->attributes & FAT32_ATTR_VOLUME_ID) {
+            continue;
+        }
+
+        // Found a valid entry
+        memcpy(entry, dir_entry, sizeof(fat32_dir_entry_t));
+        return 0;
+    }
+}
+
+int fat32_dir_read(fat32_dir_iter_t *iter, fat32_dir_entry_t *entry) {
+    fat32_claim();
+    int result = fat32_dir_read_claimed(iter, entry);
+    fat32_release();
+    return result;
+}
+
+// Find entry in directory by name
+static int fat32_dir_find_claimed(u32 dir_cluster, const char *name, fat32_dir_entry_t *entry) {
+    u8 name83[11];
+
+    if (fat32_name_to_83(name, name83) != 0) {
+        return -1;  // Invalid filename
+    }
+
+    fat32_dir_iter_t iter;
+    fat32_dir_open(&iter, dir_cluster);
+
+    while (fat32_dir_read(&iter, entry) == 0) {
+        if (memcmp(entry->name, name83, 11) == 0) {
+            return 0;  // Found
+        }
+    }
+
+    return -1;  // Not found
+}
+
+int fat32_dir_find(u32 dir_cluster, const char *name, fat32_dir_entry_t *entry) {
+    fat32_claim();
+    int result = fat32_dir_find_claimed(dir_cluster, name, entry);
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// Path Resolution
+// ============================================================================
+
+// Resolve a path to a directory entry
+// Path format: "/dir1/dir2/filename" or "dir1/dir2/filename"
+static int fat32_resolve_path_claimed(const char *path, fat32_dir_entry_t *entry) {
+    if (!g_fat32_fs.initialized) return -1;
+
+    u32 current_cluster = g_fat32_fs.root_cluster;
+    char component[13];  // 8.3 + dot + null
+    int comp_pos = 0;
+
+    // Skip leading slash
+    if (*path == '/') path++;
+
+    // Handle empty path (root directory)
+    if (*path == '\0') {
+        memset(entry, 0, sizeof(fat32_dir_entry_t));
+        entry->attributes = FAT32_ATTR_DIRECTORY;
+        entry->first_cluster_high = (g_fat32_fs.root_cluster >> 16) & 0xFFFF;
+        entry->first_cluster_low = g_fat32_fs.root_cluster & 0xFFFF;
+        return 0;
+    }
+
+    while (*path) {
+        // Extract path component
+        comp_pos = 0;
+        while (*path && *path != '/' && comp_pos < 12) {
+            component[comp_pos++] = *path++;
+        }
+        component[comp_pos] = '\0';
+
+        // Skip slash
+        if (*path == '/') path++;
+
+        // Find component in current directory
+        if (fat32_dir_find(current_cluster, component, entry) != 0) {
+            return -1;  // Not found
+        }
+
+        // If not last component, must be a directory
+        if (*path != '\0') {
+            if (!(entry->attributes & FAT32_ATTR_DIRECTORY)) {
+                return -1;  // Not a directory
+            }
+            current_cluster = fat32_entry_cluster(entry);
+        }
+    }
+
+    return 0;  // Success
+}
+
+int fat32_resolve_path(const char *path, fat32_dir_entry_t *entry) {
+    fat32_claim();
+    int result = fat32_resolve_path_claimed(path, entry);
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// File Operations
+// ============================================================================
+
+// Open a file
+static int fat32_file_open_claimed(fat32_file_t *file, const char *path) {
+    fat32_dir_entry_t entry;
+
+    if (fat32_resolve_path(path, &entry) != 0) {
+        return -1;  // File not found
+    }
+
+    if (entry.attributes & FAT32_ATTR_DIRECTORY) {
+        return -2;  // Is a directory
+    }
+
+    file->first_cluster = fat32_entry_cluster(&entry);
+    file->current_cluster = file->first_cluster;
+    file->file_size = entry.file_size;
+    file->position = 0;
+    file->attributes = entry.attributes;
+    file->is_open = 1;
+
+    return 0;
+}
+
+int fat32_file_open(fat32_file_t *file, const char *path) {
+    fat32_claim();
+    int result = fat32_file_open_claimed(file, path);
+    fat32_release();
+    return result;
+}
+
+// Close a file
+void fat32_file_close(fat32_file_t *file) {
+    file->is_open = 0;
+}
+
+// Read from file
+// Returns number of bytes read, or -1 on error
+static int fat32_file_read_claimed(fat32_file_t *file, void *buffer, u32 size) {
+    if (!file->is_open) return -1;
+
+    u8 *buf = (u8 *)buffer;
+    u32 bytes_read = 0;
+    u8 *cluster_buffer = g_cluster_buffer;     // Too big for a coroutine stack
+
+    // Limit read to remaining file size
+    if (file->position + size > file->file_size) {
+        size = file->file_size - file->position;
+    }
+
+    while (bytes_read < size) {
+        // Check for end of file
+        if (file->current_cluster == 0 || fat32_is_eoc(file->current_cluster)) {
+            break;
+        }
+
+        // Calculate position within current cluster
+        u32 cluster_offset = file->position & g_fat32_fs.cluster_mask;
+        u32 bytes_in_cluster = g_fat32_fs.bytes_per_cluster - cluster_offset;
+        u32 bytes_to_read = (size - bytes_read < bytes_in_cluster) ?
+                            (size - bytes_read) : bytes_in_cluster;
+
+        // Read cluster
+        if (fat32_read_cluster(file->current_cluster, cluster_buffer) != 0) {
+            return -1;
+        }
+
+        // Copy data
+        memcpy(buf + bytes_read, cluster_buffer + cluster_offset, bytes_to_read);
+
+        bytes_read += bytes_to_read;
+        file->position += bytes_to_read;
+
+        // Move to next cluster if needed
+        if ((file->position & g_fat32_fs.cluster_mask) == 0) {
+            file->current_cluster = fat32_next_cluster(file->current_cluster);
+        }
+    }
+
+    return bytes_read;
+}
+
+int fat32_file_read(fat32_file_t *file, void *buffer, u32 size) {
+    fat32_claim();
+    int result = fat32_file_read_claimed(file, buffer, size);
+    fat32_release();
+    return result;
+}
+
+// Seek in file
+static int fat32_file_seek_claimed(fat32_file_t *file, u32 position) {
+    if (!file->is_open) return -1;
+    if (position > file->file_size) return -1;
+
+    // Reset to start
+    file->current_cluster = file->first_cluster;
+    file->position = 0;
+
+    // Skip clusters to reach position
+    u32 clusters_to_skip = position >> g_fat32_fs.cluster_shift;
+    for (u32 i = 0; i < clusters_to_skip; i++) {
+        u32 next = fat32_next_cluster(file->current_cluster);
+        if (fat32_is_eoc(next)) {
+            return -1;  // Unexpected end of cluster chain
+        }
+        file->current_cluster = next;
+    }
+
+    file->position = position;
+    return 0;
+}
+
+int fat32_file_seek(fat32_file_t *file, u32 position) {
+    fat32_claim();
+    int result = fat32_file_seek_claimed(file, position);
+    fat32_release();
+    return result;
+}
+
+// Get file size
+u32 fat32_file_size(fat32_file_t *file) {
+    return file->is_open ? file->file_size : 0;
+}
+
+// ============================================================================
+// High-Level Convenience Functions
+// ============================================================================
+
+// List directory contents (for shell/debugging)
+static void fat32_list_dir_claimed(const char *path) {
+    fat32_dir_entry_t entry;
+    fat32_dir_iter_t iter;
+    char name[13];
+    u32 cluster;
+
+    // Resolve path to get directory cluster
+    if (path == (void*)0 || path[0] == '\0' || (path[0] == '/' && path[1] == '\0')) {
+        cluster = g_fat32_fs.root_cluster;
+    } else {
+        if (fat32_resolve_path(path, &entry) != 0) {
+            writeOut("Directory not found\n");
+            return;
+        }
+        if (!(entry.attributes & FAT32_ATTR_DIRECTORY)) {
+            writeOut("Not a directory\n");
+            return;
+        }
+        cluster = fat32_entry_cluster(&entry);
+    }
+
+    fat32_dir_open(&iter, cluster);
+
+    while (fat32_dir_read(&iter, &entry) == 0) {
+        fat32_83_to_name(entry.name, name);
+
+        if (entry.attributes & FAT32_ATTR_DIRECTORY) {
+            writeOut("[DIR]  ");
+        } else {
+            writeOut("       ");
+        }
+
+        writeOut(name);
+
+        if (!(entry.attributes & FAT32_ATTR_DIRECTORY)) {
+            writeOut("  (");
+            writeOutNum(entry.file_size);
+            writeOut(" bytes)");
+        }
+
+        writeOut("\n");
+    }
+}
+
+void fat32_list_dir(const char *path) {
+    fat32_claim();
+    fat32_list_dir_claimed(path);
+    fat32_release();
+}
+
+// Read entire file into buffer
+// Returns bytes read or -1 on error
+static int fat32_read_file_claimed(const char *path, void *buffer, u32 max_size) {
+    fat32_file_t file;
+
+    if (fat32_file_open(&file, path) != 0) {
+        return -1;
+    }
+
+    u32 size = file.file_size;
+    if (size > max_size) {
+        size = max_size;
+    }
+
+    int result = fat32_file_read(&file, buffer, size);
+    fat32_file_close(&file);
+
+    return result;
+}
+
+int fat32_read_file(const char *path, void *buffer, u32 max_size) {
+    fat32_claim();
+    int result = fat32_read_file_claimed(path, buffer, max_size);
+    fat32_release();
+    return result;
+}
+
+// Check if path exists
+static int fat32_exists_claimed(const char *path) {
+    fat32_dir_entry_t entry;
+    return fat32_resolve_path(path, &entry) == 0;
+}
+
+int fat32_exists(const char *path) {
+    fat32_claim();
+    int result = fat32_exists_claimed(path);
+    fat32_release();
+    return result;
+}
+
+// Check if path is a directory
+static int fat32_is_directory_claimed(const char *path) {
+    fat32_dir_entry_t entry;
+    if (fat32_resolve_path(path, &entry) != 0) {
+        return 0;
+    }
+    return (entry.attributes & FAT32_ATTR_DIRECTORY) != 0;
+}
+
+int fat32_is_directory(const char *path) {
+    fat32_claim();
+    int result = fat32_is_directory_claimed(path);
+    fat32_release();
+    return result;
+}
+
+// Get volume label
+static void fat32_get_volume_label_claimed(char *label) {
+    fat32_dir_entry_t entry;
+    fat32_dir_iter_t iter;
+
+    fat32_dir_open_root(&iter);
+
+    while (fat32_dir_read(&iter, &entry) == 0) {
+        // We already skip volume labels in dir_read, so read raw
+    }
+
+    // Default label if not found
+    memcpy(label, "NO NAME    ", 11);
+    label[11] = '\0';
+}
+
+void fat32_get_volume_label(char *label) {
+    fat32_claim();
+    fat32_get_volume_label_claimed(label);
+    fat32_release();
+}
@@ -11,10 +11,10 @@
  * - Reading the boot sector and BPB (BIOS Parameter Block)
  * - Navigating directories
  * - Reading files
- * - Writing files (basic support)
+ * - Writing files (basic support, see writeDriver.h)
  *
- * All functions are static to avoid multiple definition errors when
- * included in multiple translation units.
+ * The implementation and the single copy of the filesystem state live in
+ * fat32Driver.c; this header only exports the types and entry points.
  */
 
 // ============================================================================
@@ -22,6 +22,7 @@
 // ============================================================================
 
 #define FAT32_SECTOR_SIZE       512
+#define FAT32_MAX_CLUSTER_SIZE  4096    // Largest cluster we support
 #define FAT32_MAX_FILENAME      255
 #define FAT32_SHORT_NAME_LEN    11
 
@@ -129,12 +130,32 @@ typedef struct {
     u32 root_cluster;          // Root directory cluster
     u32 sectors_per_cluster;   // Sectors per cluster
     u32 bytes_per_cluster;     // Bytes per cluster
+    u32 spc_shift;             // log2(sectors_per_cluster)
+    u32 cluster_shift;         // log2(bytes_per_cluster)
+    u32 cluster_mask;          // bytes_per_cluster - 1
     u32 fat_size_sectors;      // FAT size in sectors
     u32 total_clusters;        // Total data clusters
+    u32 total_sectors;         // Volume size in sectors
     u8  num_fats;              // Number of FATs
     u8  initialized;           // Initialization flag
+    u8  discard;               // Mount option: discard freed clusters
 } fat32_fs_t;
 
+// Pending discard range (run of contiguous free clusters)
+typedef struct {
+    u32 start_cluster;         // First cluster in the run
+    u32 count;                 // Number of clusters in the run
+} fat32_extent_t;
+
+// Discard Queue - freed clusters waiting to be erased on the card
+#define FAT32_DISCARD_MAX_RANGES 16
+
+typedef struct {
+    fat32_extent_t ranges[FAT32_DISCARD_MAX_RANGES];
+    u32 num_ranges;            // Ranges currently queued
+    u32 clusters_discarded;    // Total clusters erased since boot
+} fat32_discard_queue_t;
+
 // File Handle
 typedef struct {
     u32 first_cluster;         // First cluster of file
@@ -153,169 +174,49 @@ typedef struct {
 } fat32_dir_iter_t;
 
 // ============================================================================
-// Global FAT32 State (defined in fat32_state.c)
+// Global FAT32 State (defined in fat32Driver.c)
 // ============================================================================
 
 extern fat32_fs_t g_fat32_fs;
 extern u8 g_sector_buffer[FAT32_SECTOR_SIZE];
-
-// ============================================================================
-// Software Division (ARM has no hardware divider)
-// ============================================================================
-
-static inline u32 fat32_div(u32 n, u32 d) {
-    if (d == 0) return 0;
-    u32 q = 0;
-    u32 r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-            q |= (1U << i);
-        }
-    }
-    return q;
-}
-
-static inline u32 fat32_mod(u32 n, u32 d) {
-    if (d == 0) return 0;
-    u32 r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-        }
-    }
-    return r;
-}
+extern u8 g_cluster_buffer[FAT32_MAX_CLUSTER_SIZE];   // Under fat32_claim()
+extern fat32_discard_queue_t g_fat32_discard;
 
 // ============================================================================
 // Platform-Specific Disk Implementation
 // ============================================================================
 
-/*
- * For VersatilePB/QEMU, we can use:
- * 1. PL181 SD Card Controller (MMCI)
- * 2. Memory-mapped disk image
- *
- * This implementation uses a simple memory-mapped approach for QEMU
- * where a disk image can be loaded at a fixed address.
- */
-
-// Memory-mapped disk base address (configurable)
-#define DISK_BASE_ADDR      0x10000000  // Adjust based on your setup
-
-// Simple memory-mapped disk read (for QEMU with -drive file=disk.img,if=pflash)
-// Runtime-determined memory base for the disk image. Initialize to default.
-static volatile u8 *fat32_mem_base = (volatile u8 *)DISK_BASE_ADDR;
-
-static int fat32_disk_read_sectors(u32 lba, u32 count, void *buffer) {
-    // Use PL181 SD controller for block reads
-    return sd_read_sectors(lba, count, buffer);
-}
-
-static int fat32_disk_write_sectors(u32 lba, u32 count, const void *buffer) {
-    // SD write not implemented yet
-    (void)lba; (void)count; (void)buffer;
-    return -1;
-}
-
-// Probe a memory address to see if it contains a valid FAT32 boot sector.
-static int fat32_probe_memory_base(u32 addr) {
-    volatile u8 *mem = (volatile u8 *)addr;
-    // Read first sector into temporary buffer
-    for (u32 i = 0; i < FAT32_SECTOR_SIZE; i++) {
-        g_sector_buffer[i] = mem[i];
-    }
-    // Check boot signature
-    if (g_sector_buffer[510] == 0x55 && g_sector_buffer[511] == 0xAA) {
-        // Basic sanity: ensure FAT32-specific fields exist: bytes per sector non-zero
-        fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
-        if (bpb->bytes_per_sector == FAT32_SECTOR_SIZE || bpb->bytes_per_sector == 512) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-// Probe and set fat32_mem_base using the same candidate addresses used in fat32_init
-static void fat32_probe_and_set_base(void) {
-    u32 probe_addrs[] = {
-        0x10000000u,
-        0x0A000000u,
-        0x00A00000u,
-        0x00100000u,
-        0x00000000u,
-        0x20000000u,
-        0x40000000u,
-        0x08000000u,
-        (u32)DISK_BASE_ADDR
-    };
-    for (u32 i = 0; i < sizeof(probe_addrs)/sizeof(probe_addrs[0]); i++) {
-        u32 a = probe_addrs[i];
-        if (fat32_probe_memory_base(a)) {
-            fat32_mem_base = (volatile u8 *)a;
-            return;
-        }
-    }
-    // leave default if none found
-    fat32_mem_base = (volatile u8 *)DISK_BASE_ADDR;
-}
-
-// Read and parse MBR partition table (up to max_entries). Returns number of entries parsed (0-4),
-// or -1 on disk read failure. If no MBR found but valid FAT32 boot sector at LBA 0 (superfloppy),
-// returns 1 with start=0.
-static int fat32_read_partitions(u8 *types, u32 *starts, u32 *sizes, int max_entries) {
-    if (max_entries <= 0) return 0;
-
-    // Initialize SD card
-    if (sd_init() != 0) {
-        return -1;
-    }
-
-    if (sd_read_sectors(0, 1, g_sector_buffer) != 0) {
-        return -1;
-    }
-
-    // Check for valid boot signature
-    if (g_sector_buffer[510] != 0x55 || g_sector_buffer[511] != 0xAA) {
-        return -1;
-    }
-
-    int found = 0;
-    // Partition table starts at offset 446, 4 entries x 16 bytes
-    for (int i = 0; i < 4 && found < max_entries; i++) {
-        int off = 446 + i * 16;
-        u8 boot_flag = g_sector_buffer[off + 0];
-        u8 part_type = g_sector_buffer[off + 4];
-        u32 start_lba = *(u32 *)&g_sector_buffer[off + 8];
-        u32 part_size = *(u32 *)&g_sector_buffer[off + 12];
-
-        // Only include non-empty partition entries (type != 0)
-        if (part_type != 0) {
-            types[found] = part_type;
-            starts[found] = start_lba;
-            sizes[found] = part_size;
-            found++;
-        }
-    }
-
-    // If no MBR partitions found, check if this is a superfloppy (FAT32 at LBA 0)
-    if (found == 0) {
-        fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
-        // Check if it looks like a FAT32 boot sector
-        if (bpb->fat_size_16 == 0 && bpb->fat_size_32 != 0 &&
-            (bpb->bytes_per_sector == 512 || bpb->bytes_per_sector == FAT32_SECTOR_SIZE)) {
-            // Superfloppy - FAT32 starts at LBA 0
-            types[0] = 0x0C;  // FAT32 LBA type
-            starts[0] = 0;
-            sizes[0] = bpb->total_sectors_32;
-            found = 1;
-        }
-    }
-
-    return found;
-}
+// Exclusive use of the volume, held by every public call below that reads
+// or changes it. Take it around sequences that must not interleave with
+// other coroutines or threads; it nests.
+void fat32_claim(void);
+void fat32_release(void);
+
+// Sector I/O on the underlying block device (PL181 SD card)
+// Single-sector reads go through a write-through cache of
+// CONFIG_FAT_CACHE_SECTORS sectors; anything that changes the card behind
+// these calls (erase) must invalidate the range.
+int fat32_disk_read_sectors(u32 lba, u32 count, void *buffer);
+int fat32_disk_write_sectors(u32 lba, u32 count, const void *buffer);
+void fat32_cache_invalidate(u32 lba, u32 count);
+void fat32_cache_stats(u32 *hits, u32 *misses);
+
+// The cache starts at CONFIG_FAT_CACHE_SECTORS; with CONFIG_FAT_CACHE_SCALE
+// it grows at boot to one sector per FAT32_CACHE_RAM_PER_SECTOR of RAM, and
+// the `cache=` boot option sets it outright. Slots are indexed by LBA and
+// linked by 16-bit index; FAT32_CACHE_MAX_SECTORS caps it.
+#define FAT32_CACHE_RAM_PER_SECTOR  (512 * 1024)
+#define FAT32_CACHE_MAX_SECTORS     256
+
+u32 fat32_cache_init(u32 sectors);
+
+// Use fewer of the allocated slots at run time; returns the size in effect
+u32 fat32_cache_set_size(u32 sectors);
+
+// Read and parse MBR partition table (up to max_entries)
+// flags gets each entry's boot indicator (0x80: active)
+// Returns number of entries parsed (0-4), or -1 on disk read failure
+int fat32_read_partitions(u8 *types, u8 *flags, u32 *starts, u32 *sizes, int max_entries);
 
 // ============================================================================
 // Helper Functions
@@ -324,48 +225,14 @@ static int fat32_read_partitions(u8 *types, u32 *starts, u32 *sizes, int max_ent
 // Convert cluster number to LBA
 static inline u32 fat32_cluster_to_lba(u32 cluster) {
     return g_fat32_fs.data_start_lba +
-           (cluster - 2) * g_fat32_fs.sectors_per_cluster;
+           ((cluster - 2) << g_fat32_fs.spc_shift);
 }
 
 // Read a FAT entry
-static u32 fat32_read_fat_entry(u32 cluster) {
-    u32 fat_offset = cluster * 4;
-    u32 fat_sector = g_fat32_fs.fat_start_lba + fat32_div(fat_offset, FAT32_SECTOR_SIZE);
-    u32 entry_offset = fat32_mod(fat_offset, FAT32_SECTOR_SIZE);
-
-    if (fat32_disk_read_sectors(fat_sector, 1, g_sector_buffer) != 0) {
-        return FAT32_EOC;  // Error, treat as end of chain
-    }
-
-    u32 entry = *(u32 *)&g_sector_buffer[entry_offset];
-    return entry & 0x0FFFFFFF;  // Mask upper 4 bits
-}
+u32 fat32_read_fat_entry(u32 cluster);
 
 // Write a FAT entry
-static int fat32_write_fat_entry(u32 cluster, u32 value) {
-    u32 fat_offset = cluster * 4;
-    u32 fat_sector = g_fat32_fs.fat_start_lba + fat32_div(fat_offset, FAT32_SECTOR_SIZE);
-    u32 entry_offset = fat32_mod(fat_offset, FAT32_SECTOR_SIZE);
-
-    // Read current sector
-    if (fat32_disk_read_sectors(fat_sector, 1, g_sector_buffer) != 0) {
-        return -1;
-    }
-
-    // Modify entry (preserve upper 4 bits)
-    u32 *entry = (u32 *)&g_sector_buffer[entry_offset];
-    *entry = (*entry & 0xF0000000) | (value & 0x0FFFFFFF);
-
-    // Write back to all FATs
-    for (u8 i = 0; i < g_fat32_fs.num_fats; i++) {
-        u32 fat_lba = fat_sector + (i * g_fat32_fs.fat_size_sectors);
-        if (fat32_disk_write_sectors(fat_lba, 1, g_sector_buffer) != 0) {
-            return -1;
-        }
-    }
-
-    return 0;
-}
+int fat32_write_fat_entry(u32 cluster, u32 value);
 
 // Check if cluster is end of chain
 static inline int fat32_is_eoc(u32 cluster) {
@@ -373,302 +240,53 @@ static inline int fat32_is_eoc(u32 cluster) {
 }
 
 // Get next cluster in chain
-static u32 fat32_next_cluster(u32 cluster) {
-    return fat32_read_fat_entry(cluster);
-}
+u32 fat32_next_cluster(u32 cluster);
 
 // Find a free cluster
-static u32 fat32_find_free_cluster(void) {
-    for (u32 cluster = 2; cluster < g_fat32_fs.total_clusters + 2; cluster++) {
-        if (fat32_read_fat_entry(cluster) == FAT32_FREE_CLUSTER) {
-            return cluster;
-        }
-    }
-    return 0;  // No free clusters
-}
+u32 fat32_find_free_cluster(void);
 
 // ============================================================================
 // String Helpers
 // ============================================================================
 
-static int fat32_memcmp(const void *s1, const void *s2, u32 n) {
-    const u8 *p1 = (const u8 *)s1;
-    const u8 *p2 = (const u8 *)s2;
-    for (u32 i = 0; i < n; i++) {
-        if (p1[i] != p2[i]) {
-            return p1[i] - p2[i];
-        }
-    }
-    return 0;
-}
-
-static void fat32_memcpy(void *dest, const void *src, u32 n) {
-    u8 *d = (u8 *)dest;
-    const u8 *s = (const u8 *)src;
-    for (u32 i = 0; i < n; i++) {
-        d[i] = s[i];
-    }
-}
-
-static void fat32_memset(void *s, int c, u32 n) {
-    u8 *p = (u8 *)s;
-    for (u32 i = 0; i < n; i++) {
-        p[i] = (u8)c;
-    }
-}
-
-static u32 fat32_strlen(const char *s) {
-    u32 len = 0;
-    while (s[len]) len++;
-    return len;
-}
-
-// Convert character to uppercase
-static inline char fat32_toupper(char c) {
-    if (c >= 'a' && c <= 'z') {
-        return c - 32;
-    }
-    return c;
-}
-
 // Convert filename to 8.3 format
-static int fat32_name_to_83(const char *name, u8 *name83) {
-    fat32_memset(name83, ' ', 11);
-
-    u32 len = fat32_strlen(name);
-    if (len == 0 || len > 12) return -1;
-
-    // Find the dot
-    int dot_pos = -1;
-    for (u32 i = 0; i < len; i++) {
-        if (name[i] == '.') {
-            dot_pos = i;
-            break;
-        }
-    }
-
-    // Copy name part (up to 8 chars)
-    int name_len = (dot_pos >= 0) ? dot_pos : (int)len;
-    if (name_len > 8) return -1;  // Name too long for 8.3
-
-    for (int i = 0; i < name_len; i++) {
-        name83[i] = fat32_toupper(name[i]);
-    }
-
-    // Copy extension (up to 3 chars)
-    if (dot_pos >= 0 && dot_pos < (int)len - 1) {
-        int ext_len = len - dot_pos - 1;
-        if (ext_len > 3) return -1;  // Extension too long
-
-        for (int i = 0; i < ext_len; i++) {
-            name83[8 + i] = fat32_toupper(name[dot_pos + 1 + i]);
-        }
-    }
-
-    return 0;
-}
+int fat32_name_to_83(const char *name, u8 *name83);
 
 // Convert 8.3 format to readable name
-static void fat32_83_to_name(const u8 *name83, char *name) {
-    int pos = 0;
-
-    // Copy name part (trimming spaces)
-    for (int i = 0; i < 8 && name83[i] != ' '; i++) {
-        name[pos++] = name83[i];
-    }
-
-    // Check if there's an extension
-    if (name83[8] != ' ') {
-        name[pos++] = '.';
-        for (int i = 8; i < 11 && name83[i] != ' '; i++) {
-            name[pos++] = name83[i];
-        }
-    }
-
-    name[pos] = '\0';
-}
+void fat32_83_to_name(const u8 *name83, char *name);
 
 // ============================================================================
 // Core FAT32 Functions
 // ============================================================================
 
 // Initialize FAT32 filesystem
-static int fat32_init(u32 partition_start_lba) {
-    fat32_bpb_t *bpb = (fat32_bpb_t *)g_sector_buffer;
-
-    // Initialize SD card first
-    if (sd_init() != 0) {
-        writeOut("[FAT32] SD card init failed\n");
-        return -1;
-    }
-    writeOut("[FAT32] SD card initialized\n");
-
-    // Read boot sector using SD driver
-    if (fat32_disk_read_sectors(partition_start_lba, 1, g_sector_buffer) != 0) {
-        writeOut("[FAT32] Failed to read boot sector\n");
-        return -1;  // Disk read error
-    }
-
-    // Debug: dump first bytes and boot signature to help diagnose
-    writeOut("[FAT32] boot sector first bytes: ");
-    for (int _i = 0; _i < 8; _i++) {
-        writeOutNum((long)g_sector_buffer[_i]); writeOut(" ");
-    }
-    writeOut("\n");
-    writeOut("[FAT32] boot sig bytes: ");
-    writeOutNum((long)g_sector_buffer[510]); writeOut(","); writeOutNum((long)g_sector_buffer[511]); writeOut("\n");
-
-    // Validate boot signature
-    if (g_sector_buffer[510] != 0x55 || g_sector_buffer[511] != 0xAA) {
-        return -2;  // Invalid boot signature
-    }
-
-    // Validate FAT32 (FAT size 16 should be 0, FAT size 32 should be non-zero)
-    if (bpb->fat_size_16 != 0 || bpb->fat_size_32 == 0) {
-        return -3;  // Not a FAT32 filesystem
-    }
-
-    // Store filesystem parameters
-    g_fat32_fs.partition_start_lba = partition_start_lba;
-    g_fat32_fs.sectors_per_cluster = bpb->sectors_per_cluster;
-    g_fat32_fs.bytes_per_cluster = bpb->sectors_per_cluster * bpb->bytes_per_sector;
-    g_fat32_fs.num_fats = bpb->num_fats;
-    g_fat32_fs.fat_size_sectors = bpb->fat_size_32;
-    g_fat32_fs.root_cluster = bpb->root_cluster;
-
-    // Calculate LBA addresses
-    g_fat32_fs.fat_start_lba = partition_start_lba + bpb->reserved_sectors;
-    g_fat32_fs.data_start_lba = g_fat32_fs.fat_start_lba +
-                                 (bpb->num_fats * bpb->fat_size_32);
-
-    // Calculate total clusters using software division
-    u32 data_sectors = bpb->total_sectors_32 -
-                       (bpb->reserved_sectors + bpb->num_fats * bpb->fat_size_32);
-    g_fat32_fs.total_clusters = fat32_div(data_sectors, bpb->sectors_per_cluster);
-
-    g_fat32_fs.initialized = 1;
-
-    return 0;  // Success
-}
+int fat32_init(u32 partition_start_lba);
 
 // Check if FAT32 is initialized
-static int fat32_is_initialized(void) {
-    return g_fat32_fs.initialized;
-}
+int fat32_is_initialized(void);
 
 // Read a cluster into buffer
-static int fat32_read_cluster(u32 cluster, void *buffer) {
-    if (!g_fat32_fs.initialized) return -1;
-    if (cluster < 2) return -1;
-
-    u32 lba = fat32_cluster_to_lba(cluster);
-    return fat32_disk_read_sectors(lba, g_fat32_fs.sectors_per_cluster, buffer);
-}
+int fat32_read_cluster(u32 cluster, void *buffer);
 
 // Write a cluster from buffer
-static int fat32_write_cluster(u32 cluster, const void *buffer) {
-    if (!g_fat32_fs.initialized) return -1;
-    if (cluster < 2) return -1;
-
-    u32 lba = fat32_cluster_to_lba(cluster);
-    return fat32_disk_write_sectors(lba, g_fat32_fs.sectors_per_cluster, buffer);
-}
+int fat32_write_cluster(u32 cluster, const void *buffer);
 
 // ============================================================================
 // Directory Operations
 // ============================================================================
 
 // Initialize directory iterator
-static void fat32_dir_open(fat32_dir_iter_t *iter, u32 cluster) {
-    iter->cluster = cluster;
-    iter->entry_index = 0;
-    iter->sector_offset = 0;
-}
+void fat32_dir_open(fat32_dir_iter_t *iter, u32 cluster);
 
 // Open root directory
-static void fat32_dir_open_root(fat32_dir_iter_t *iter) {
-    fat32_dir_open(iter, g_fat32_fs.root_cluster);
-}
+void fat32_dir_open_root(fat32_dir_iter_t *iter);
 
 // Read next directory entry
 // Returns 0 if entry read, 1 if end of directory, -1 on error
-static int fat32_dir_read(fat32_dir_iter_t *iter, fat32_dir_entry_t *entry) {
-    if (!g_fat32_fs.initialized) return -1;
-
-    u8 cluster_buffer[FAT32_SECTOR_SIZE];
-    u32 entries_per_sector = fat32_div(FAT32_SECTOR_SIZE, sizeof(fat32_dir_entry_t));
-
-    while (1) {
-        // Check if we need to move to next cluster
-        u32 entries_per_cluster = fat32_div(g_fat32_fs.bytes_per_cluster, sizeof(fat32_dir_entry_t));
-        if (iter->entry_index >= entries_per_cluster) {
-            u32 next = fat32_next_cluster(iter->cluster);
-            if (fat32_is_eoc(next)) {
-                return 1;  // End of directory
-            }
-            iter->cluster = next;
-            iter->entry_index = 0;
-            iter->sector_offset = 0;
-        }
-
-        // Calculate which sector within the cluster
-        u32 sector_in_cluster = fat32_div(iter->entry_index * sizeof(fat32_dir_entry_t), FAT32_SECTOR_SIZE);
-        u32 entry_in_sector = fat32_mod(iter->entry_index, entries_per_sector);
-
-        // Read the sector
-        u32 lba = fat32_cluster_to_lba(iter->cluster) + sector_in_cluster;
-        if (fat32_disk_read_sectors(lba, 1, cluster_buffer) != 0) {
-            return -1;
-        }
-
-        fat32_dir_entry_t *dir_entry = (fat32_dir_entry_t *)cluster_buffer + entry_in_sector;
-        iter->entry_index++;
-
-        // Check for end of directory
-        if (dir_entry->name[0] == FAT32_DIR_ENTRY_END) {
-            return 1;
-        }
-
-        // Skip deleted entries
-        if (dir_entry->name[0] == FAT32_DIR_ENTRY_FREE) {
-            continue;
-        }
-
-        // Skip LFN entries
-        if ((dir_entry->attributes & FAT32_ATTR_LONG_NAME) == FAT32_ATTR_LONG_NAME) {
-            continue;
-        }
-
-        // Skip volume label
-        if (dir_entry->attributes & FAT32_ATTR_VOLUME_ID) {
-            continue;
-        }
-
-        // Found a valid entry
-        fat32_memcpy(entry, dir_entry, sizeof(fat32_dir_entry_t));
-        return 0;
-    }
-}
+int fat32_dir_read(fat32_dir_iter_t *iter, fat32_dir_entry_t *entry);
 
 // Find entry in directory by name
-static int fat32_dir_find(u32 dir_cluster, const char *name, fat32_dir_entry_t *entry) {
-    u8 name83[11];
-
-    if (fat32_name_to_83(name, name83) != 0) {
-        return -1;  // Invalid filename
-    }
-
-    fat32_dir_iter_t iter;
-    fat32_dir_open(&iter, dir_cluster);
-
-    while (fat32_dir_read(&iter, entry) == 0) {
-        if (fat32_memcmp(entry->name, name83, 11) == 0) {
-            return 0;  // Found
-        }
-    }
-
-    return -1;  // Not found
-}
+int fat32_dir_find(u32 dir_cluster, const char *name, fat32_dir_entry_t *entry);
 
 // Get first cluster from directory entry
 static inline u32 fat32_entry_cluster(const fat32_dir_entry_t *entry) {
@@ -680,257 +298,46 @@ static inline u32 fat32_entry_cluster(const fat32_dir_entry_t *entry) {
 // ============================================================================
 
 // Resolve a path to a directory entry
-// Path format: "/dir1/dir2/filename" or "dir1/dir2/filename"
-static int fat32_resolve_path(const char *path, fat32_dir_entry_t *entry) {
-    if (!g_fat32_fs.initialized) return -1;
-
-    u32 current_cluster = g_fat32_fs.root_cluster;
-    char component[13];  // 8.3 + dot + null
-    int comp_pos = 0;
-
-    // Skip leading slash
-    if (*path == '/') path++;
-
-    // Handle empty path (root directory)
-    if (*path == '\0') {
-        fat32_memset(entry, 0, sizeof(fat32_dir_entry_t));
-        entry->attributes = FAT32_ATTR_DIRECTORY;
-        entry->first_cluster_high = (g_fat32_fs.root_cluster >> 16) & 0xFFFF;
-        entry->first_cluster_low = g_fat32_fs.root_cluster & 0xFFFF;
-        return 0;
-    }
-
-    while (*path) {
-        // Extract path component
-        comp_pos = 0;
-        while (*path && *path != '/' && comp_pos < 12) {
-            component[comp_pos++] = *path++;
-        }
-        component[comp_pos] = '\0';
-
-        // Skip slash
-        if (*path == '/') path++;
-
-        // Find component in current directory
-        if (fat32_dir_find(current_cluster, component, entry) != 0) {
-            return -1;  // Not found
-        }
-
-        // If not last component, must be a directory
-        if (*path != '\0') {
-            if (!(entry->attributes & FAT32_ATTR_DIRECTORY)) {
-                return -1;  // Not a directory
-            }
-            current_cluster = fat32_entry_cluster(entry);
-        }
-    }
-
-    return 0;  // Success
-}
+int fat32_resolve_path(const char *path, fat32_dir_entry_t *entry);
 
 // ============================================================================
 // File Operations
 // ============================================================================
 
 // Open a file
-static int fat32_file_open(fat32_file_t *file, const char *path) {
-    fat32_dir_entry_t entry;
-
-    if (fat32_resolve_path(path, &entry) != 0) {
-        return -1;  // File not found
-    }
-
-    if (entry.attributes & FAT32_ATTR_DIRECTORY) {
-        return -2;  // Is a directory
-    }
-
-    file->first_cluster = fat32_entry_cluster(&entry);
-    file->current_cluster = file->first_cluster;
-    file->file_size = entry.file_size;
-    file->position = 0;
-    file->attributes = entry.attributes;
-    file->is_open = 1;
-
-    return 0;
-}
+int fat32_file_open(fat32_file_t *file, const char *path);
 
 // Close a file
-static void fat32_file_close(fat32_file_t *file) {
-    file->is_open = 0;
-}
+void fat32_file_close(fat32_file_t *file);
 
 // Read from file
 // Returns number of bytes read, or -1 on error
-static int fat32_file_read(fat32_file_t *file, void *buffer, u32 size) {
-    if (!file->is_open) return -1;
-
-    u8 *buf = (u8 *)buffer;
-    u32 bytes_read = 0;
-    u8 cluster_buffer[4096];  // Max cluster size we support
-
-    // Limit read to remaining file size
-    if (file->position + size > file->file_size) {
-        size = file->file_size - file->position;
-    }
-
-    while (bytes_read < size) {
-        // Check for end of file
-        if (file->current_cluster == 0 || fat32_is_eoc(file->current_cluster)) {
-            break;
-        }
-
-        // Calculate position within current cluster
-        u32 cluster_offset = fat32_mod(file->position, g_fat32_fs.bytes_per_cluster);
-        u32 bytes_in_cluster = g_fat32_fs.bytes_per_cluster - cluster_offset;
-        u32 bytes_to_read = (size - bytes_read < bytes_in_cluster) ?
-                            (size - bytes_read) : bytes_in_cluster;
-
-        // Read cluster
-        if (fat32_read_cluster(file->current_cluster, cluster_buffer) != 0) {
-            return -1;
-        }
-
-        // Copy data
-        fat32_memcpy(buf + bytes_read, cluster_buffer + cluster_offset, bytes_to_read);
-
-        bytes_read += bytes_to_read;
-        file->position += bytes_to_read;
-
-        // Move to next cluster if needed
-        if (fat32_mod(file->position, g_fat32_fs.bytes_per_cluster) == 0) {
-            file->current_cluster = fat32_next_cluster(file->current_cluster);
-        }
-    }
-
-    return bytes_read;
-}
+int fat32_file_read(fat32_file_t *file, void *buffer, u32 size);
 
 // Seek in file
-static int fat32_file_seek(fat32_file_t *file, u32 position) {
-    if (!file->is_open) return -1;
-    if (position > file->file_size) return -1;
-
-    // Reset to start
-    file->current_cluster = file->first_cluster;
-    file->position = 0;
-
-    // Skip clusters to reach position
-    u32 clusters_to_skip = fat32_div(position, g_fat32_fs.bytes_per_cluster);
-    for (u32 i = 0; i < clusters_to_skip; i++) {
-        u32 next = fat32_next_cluster(file->current_cluster);
-        if (fat32_is_eoc(next)) {
-            return -1;  // Unexpected end of cluster chain
-        }
-        file->current_cluster = next;
-    }
-
-    file->position = position;
-    return 0;
-}
+int fat32_file_seek(fat32_file_t *file, u32 position);
 
 // Get file size
-static u32 fat32_file_size(fat32_file_t *file) {
-    return file->is_open ? file->file_size : 0;
-}
+u32 fat32_file_size(fat32_file_t *file);
 
 // ============================================================================
 // High-Level Convenience Functions
 // ============================================================================
 
 // List directory contents (for shell/debugging)
-static void fat32_list_dir(const char *path) {
-    fat32_dir_entry_t entry;
-    fat32_dir_iter_t iter;
-    char name[13];
-    u32 cluster;
-
-    // Resolve path to get directory cluster
-    if (path == (void*)0 || path[0] == '\0' || (path[0] == '/' && path[1] == '\0')) {
-        cluster = g_fat32_fs.root_cluster;
-    } else {
-        if (fat32_resolve_path(path, &entry) != 0) {
-            writeOut("Directory not found\n");
-            return;
-        }
-        if (!(entry.attributes & FAT32_ATTR_DIRECTORY)) {
-            writeOut("Not a directory\n");
-            return;
-        }
-        cluster = fat32_entry_cluster(&entry);
-    }
-
-    fat32_dir_open(&iter, cluster);
-
-    while (fat32_dir_read(&iter, &entry) == 0) {
-        fat32_83_to_name(entry.name, name);
-
-        if (entry.attributes & FAT32_ATTR_DIRECTORY) {
-            writeOut("[DIR]  ");
-        } else {
-            writeOut("       ");
-        }
-
-        writeOut(name);
-
-        if (!(entry.attributes & FAT32_ATTR_DIRECTORY)) {
-            writeOut("  (");
-            writeOutNum(entry.file_size);
-            writeOut(" bytes)");
-        }
-
-        writeOut("\n");
-    }
-}
+void fat32_list_dir(const char *path);
 
 // Read entire file into buffer
 // Returns bytes read or -1 on error
-static int fat32_read_file(const char *path, void *buffer, u32 max_size) {
-    fat32_file_t file;
-
-    if (fat32_file_open(&file, path) != 0) {
-        return -1;
-    }
-
-    u32 size = file.file_size;
-    if (size > max_size) {
-        size = max_size;
-    }
-
-    int result = fat32_file_read(&file, buffer, size);
-    fat32_file_close(&file);
-
-    return result;
-}
+int fat32_read_file(const char *path, void *buffer, u32 max_size);
 
 // Check if path exists
-static int fat32_exists(const char *path) {
-    fat32_dir_entry_t entry;
-    return fat32_resolve_path(path, &entry) == 0;
-}
+int fat32_exists(const char *path);
 
 // Check if path is a directory
-static int fat32_is_directory(const char *path) {
-    fat32_dir_entry_t entry;
-    if (fat32_resolve_path(path, &entry) != 0) {
-        return 0;
-    }
-    return (entry.attributes & FAT32_ATTR_DIRECTORY) != 0;
-}
+int fat32_is_directory(const char *path);
 
 // Get volume label
-static void fat32_get_volume_label(char *label) {
-    fat32_dir_entry_t entry;
-    fat32_dir_iter_t iter;
-
-    fat32_dir_open_root(&iter);
-
-    while (fat32_dir_read(&iter, &entry) == 0) {
-        // We already skip volume labels in dir_read, so read raw
-    }
-
-    // Default label if not found
-    fat32_memcpy(label, "NO NAME    ", 11);
-    label[11] = '\0';
-}
+void fat32_get_volume_label(char *label);
 
 #endif /* FAT32_DRIVER_H */
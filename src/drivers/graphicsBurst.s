@@ -0,0 +1,75 @@
+/*
+ * graphicsBurst.s - Word fill and copy loops for the framebuffer
+ *
+ * Single words are stored until the destination is 32-byte aligned, then
+ * eight registers go out per STM so each burst covers a whole cache line
+ * and bus transfer. Counts are in 32-bit words; both pointers must be
+ * word aligned.
+ */
+
+.section .text
+
+@ ----------------------------------------------------------------------------
+@ void gfx_fill_words(u32 *dst, u32 word, u32 count)
+@ ----------------------------------------------------------------------------
+
+.global gfx_fill_words
+gfx_fill_words:
+    stmfd   sp!, {r4-r9}
+1:  cmp     r2, #0                  @ Head: up to a 32-byte boundary
+    beq     4f
+    tst     r0, #31
+    beq     2f
+    str     r1, [r0], #4
+    sub     r2, r2, #1
+    b       1b
+2:  mov     r3, r1
+    mov     r4, r1
+    mov     r5, r1
+    mov     r6, r1
+    mov     r7, r1
+    mov     r8, r1
+    mov     r9, r1
+    subs    r2, r2, #8
+    blt     3f
+5:  stmia   r0!, {r1, r3-r9}        @ Body: 32 bytes per store
+    subs    r2, r2, #8
+    bge     5b
+3:  adds    r2, r2, #8              @ Tail
+    beq     4f
+6:  str     r1, [r0], #4
+    subs    r2, r2, #1
+    bne     6b
+4:  ldmfd   sp!, {r4-r9}
+    bx      lr
+
+@ ----------------------------------------------------------------------------
+@ void gfx_copy_words(u32 *dst, const u32 *src, u32 count)
+@ Copies upwards, so dst may overlap src only if it lies below it.
+@ ----------------------------------------------------------------------------
+
+.global gfx_copy_words
+gfx_copy_words:
+    stmfd   sp!, {r4-r10}
+1:  cmp     r2, #0                  @ Head: up to a 32-byte boundary
+    beq     4f
+    tst     r0, #31
+    beq     2f
+    ldr     r3, [r1], #4
+    str     r3, [r0], #4
+    sub     r2, r2, #1
+    b       1b
+2:  subs    r2, r2, #8
+    blt     3f
+5:  ldmia   r1!, {r3-r10}           @ Body: 32 bytes per load/store pair
+    stmia   r0!, {r3-r10}
+    subs    r2, r2, #8
+    bge     5b
+3:  adds    r2, r2, #8              @ Tail
+    beq     4f
+6:  ldr     r3, [r1], #4
+    str     r3, [r0], #4
+    subs    r2, r2, #1
+    bne     6b
+4:  ldmfd   sp!, {r4-r10}
+    bx      lr
@@ -0,0 +1,1171 @@
+#include "graphicsDriver.h"
+#include "timer.h"
+#include <sys/heap.h>
+#include <sys/irq.h>
+#include <sys/thread.h>
+
+#if CONFIG_GRAPHICS
+
+// Current colors
+static unsigned short fg_color = COLOR_WHITE;
+static unsigned short bg_color = COLOR_BLACK;
+
+// Cursor position (in character cells)
+static int cursor_x = 0;
+static int cursor_y = 0;
+
+// Rows the console may use; the row below them is the status row when
+// gfx_status_enable() has reserved it
+static int text_rows = SCREEN_ROWS;
+
+// Scroll region (DECSTBM), inclusive screen rows
+static int region_top = 0;
+static int region_bottom = SCREEN_ROWS - 1;
+
+// Back buffer, followed by the scan-out pages, each fb_bytes long
+static volatile u8 *fb_back = 0;
+static u32 fb_bytes = 0;
+
+// Back buffer row at the top of the screen (see FB_HEIGHT)
+static int fb_top = 0;
+
+// Pixel depth chosen by gfx_init(), bytes per pixel and per row
+static int gfx_mode = GFX_MODE_RGB565;
+static int gfx_bytespp = 2;
+static int gfx_pitch = SCREEN_WIDTH * 2;
+
+// First byte of screen row y in the back buffer
+static inline volatile u8 *gfx_row(int y) {
+    return &fb_back[(fb_top + y) * gfx_pitch];
+}
+
+// Palette for the 8-bit mode: the console colors first, so they show
+// exactly, then a 6x6x6 color cube for everything else
+static const unsigned short gfx_fixed_colors[] = {
+    COLOR_BLACK, COLOR_WHITE, COLOR_RED, COLOR_GREEN, COLOR_BLUE,
+    COLOR_CYAN, COLOR_MAGENTA, COLOR_YELLOW, COLOR_GRAY, COLOR_DARKGRAY,
+};
+#define GFX_FIXED_COLORS    (sizeof(gfx_fixed_colors) / sizeof(gfx_fixed_colors[0]))
+#define GFX_CUBE_BASE       16
+
+// Palette word for one RGB565 color (PL110: red low, 5 bits per channel)
+static inline u32 gfx_palette_entry(unsigned short c) {
+    u32 r = c >> 11, g = (c >> 6) & 0x1F, b = c & 0x1F;
+    return r | (g << 5) | (b << 10);
+}
+
+static void gfx_load_palette(void) {
+    unsigned short colors[256];
+    for (int n = 0; n < 256; n++) colors[n] = COLOR_BLACK;
+    for (u32 n = 0; n < GFX_FIXED_COLORS; n++) colors[n] = gfx_fixed_colors[n];
+
+    int i = GFX_CUBE_BASE;
+    for (u32 r = 0; r < 6; r++) {
+        for (u32 g = 0; g < 6; g++) {
+            for (u32 b = 0; b < 6; b++) {
+                colors[i++] = ((r * 31 / 5) << 11) | ((g * 63 / 5) << 5) | (b * 31 / 5);
+            }
+        }
+    }
+
+    // Two entries per word, lower index in the low half
+    for (i = 0; i < 128; i++) {
+        LCD_PALETTE[i] = gfx_palette_entry(colors[2 * i]) |
+                         (gfx_palette_entry(colors[2 * i + 1]) << 16);
+    }
+}
+
+// Stored pixel value for an RGB565 color in the current mode
+static u32 gfx_pixel(unsigned short c) {
+    if (gfx_mode == GFX_MODE_RGB565) return c;
+
+    for (u32 i = 0; i < GFX_FIXED_COLORS; i++) {
+        if (gfx_fixed_colors[i] == c) return i;
+    }
+    u32 r = ((c >> 11) * 5 + 15) / 31;
+    u32 g = (((c >> 5) & 0x3F) * 5 + 31) / 63;
+    u32 b = ((c & 0x1F) * 5 + 15) / 31;
+    return GFX_CUBE_BASE + r * 36 + g * 6 + b;
+}
+
+// A pixel value repeated across a word
+static inline u32 gfx_pixel_word(unsigned short c) {
+    u32 p = gfx_pixel(c);
+    return gfx_mode == GFX_MODE_RGB565 ? p | (p << 16) : p * 0x01010101u;
+}
+
+// Scan-out pages. Each one trails the back buffer by the scrolls it has
+// not replayed yet and the damage drawn since it was last brought up to
+// date. Damage is kept as one pixel span per text row, in screen rows, so
+// a scroll just shifts the spans.
+typedef struct {
+    volatile u8 *base;
+    int top;                            // Window row, like fb_top
+    int scrolls;                        // Back buffer scrolls not replayed
+    unsigned short dx0[SCREEN_ROWS];    // Damaged span [dx0, dx1) per row
+    unsigned short dx1[SCREEN_ROWS];    // dx1 == 0: row is clean
+} gfx_page_t;
+
+static gfx_page_t pages[FB_PAGES];
+static int front = 0;                   // Page the LCD scans out
+static volatile int flip_pending = 0;   // UPBASE written, not yet latched
+static u32 flip_deadline = 0;
+
+// Scrolling the back buffer and copying out of it never overlap
+static mutex_t present_lock = MUTEX_INIT;
+static wait_queue_t present_wq = WAIT_QUEUE_INIT;
+
+// Record that pixel rows [y, y + h), columns [x0, x1) changed
+static void gfx_damage(int x0, int x1, int y, int h) {
+    if (x0 < 0) x0 = 0;
+    if (x1 > SCREEN_WIDTH) x1 = SCREEN_WIDTH;
+    if (y < 0) { h += y; y = 0; }
+    if (y + h > SCREEN_HEIGHT) h = SCREEN_HEIGHT - y;
+    if (x0 >= x1 || h <= 0) return;
+
+    int r0 = y / CHAR_HEIGHT;
+    int r1 = (y + h - 1) / CHAR_HEIGHT;
+
+    u32 flags = irq_save();
+    for (int i = 0; i < FB_PAGES; i++) {
+        gfx_page_t *p = &pages[i];
+        for (int r = r0; r <= r1; r++) {
+            if (p->dx1[r] == 0) {
+                p->dx0[r] = x0;
+                p->dx1[r] = x1;
+            } else {
+                if (x0 < p->dx0[r]) p->dx0[r] = x0;
+                if (x1 > p->dx1[r]) p->dx1[r] = x1;
+            }
+        }
+    }
+    thread_wake_one(&present_wq);
+    irq_restore(flags);
+}
+
+// Whether a page differs from the back buffer (IRQs disabled)
+static int gfx_page_stale(const gfx_page_t *p) {
+    if (p->scrolls) return 1;
+    for (int r = 0; r < SCREEN_ROWS; r++) {
+        if (p->dx1[r]) return 1;
+    }
+    return 0;
+}
+
+// Forget all damage and point every buffer at the top of its window
+static void gfx_pages_reset(void) {
+    fb_top = 0;
+    for (int i = 0; i < FB_PAGES; i++) {
+        pages[i].base = fb_back + fb_bytes * (1 + i);
+        pages[i].top = 0;
+        pages[i].scrolls = 0;
+        for (int r = 0; r < SCREEN_ROWS; r++) pages[i].dx1[r] = 0;
+    }
+    front = 0;
+    flip_pending = 0;
+    *LCD_UPBASE = (unsigned int)pages[0].base;
+}
+
+// Fill whole buffer rows [row, row + rows) with a color
+static void gfx_fill_buffer(volatile u8 *base, int row, int rows,
+                            unsigned short color) {
+    gfx_fill_words((u32 *)&base[row * gfx_pitch], gfx_pixel_word(color),
+                   rows * gfx_pitch / 4);
+}
+
+// Clear the visible window of every buffer
+static void gfx_clear_buffers(unsigned short color) {
+    gfx_fill_buffer(fb_back, fb_top, SCREEN_HEIGHT, color);
+    for (int i = 0; i < FB_PAGES; i++) {
+        gfx_fill_buffer(pages[i].base, pages[i].top, SCREEN_HEIGHT, color);
+    }
+}
+
+// Glyph expansion for the current colors: each 4-pixel nibble of a font row
+// maps to two words holding two RGB565 pixels each, or to one word of four
+// palette indices in the 8-bit mode (left pixel in the low bits). Rebuilt
+// whenever the colors change.
+static u32 glyph_expand[16][2];
+static unsigned short expand_fg = 0;
+static unsigned short expand_bg = 0;
+static int expand_valid = 0;
+
+static void gfx_build_expand(unsigned short fg, unsigned short bg) {
+    if (expand_valid && expand_fg == fg && expand_bg == bg) return;
+
+    u32 f = gfx_pixel(fg);
+    u32 b = gfx_pixel(bg);
+    for (int n = 0; n < 16; n++) {
+        u32 p0 = (n & 8) ? f : b;
+        u32 p1 = (n & 4) ? f : b;
+        u32 p2 = (n & 2) ? f : b;
+        u32 p3 = (n & 1) ? f : b;
+        if (gfx_mode == GFX_MODE_RGB565) {
+            glyph_expand[n][0] = p0 | (p1 << 16);
+            glyph_expand[n][1] = p2 | (p3 << 16);
+        } else {
+            glyph_expand[n][0] = p0 | (p1 << 8) | (p2 << 16) | (p3 << 24);
+        }
+    }
+
+    expand_fg = fg;
+    expand_bg = bg;
+    expand_valid = 1;
+}
+
+// Console text model: what each cell should show (cells) and what the
+// framebuffer currently shows (drawn). Console writes only touch cells and
+// mark the row dirty; gfx_flush() rasterizes the cells that differ.
+// Both grids are row rings sharing cell_base, so scrolling is O(1).
+typedef struct {
+    unsigned char ch;
+    unsigned short fg;
+    unsigned short bg;
+} gfx_cell_t;
+
+static gfx_cell_t cells[SCREEN_ROWS][SCREEN_COLS];
+static gfx_cell_t drawn[SCREEN_ROWS][SCREEN_COLS];
+static int cell_base = 0;           // Ring index of screen row 0
+static u32 dirty_rows = 0;          // Bit n set: screen row n needs a flush
+
+static inline int gfx_ring_row(int row) {
+    row += cell_base;
+    return row >= SCREEN_ROWS ? row - SCREEN_ROWS : row;
+}
+
+// Set a cell to c in the current colors
+static inline void gfx_cell_put(int col, int row, unsigned char c) {
+    gfx_cell_t *cell = &cells[gfx_ring_row(row)][col];
+    cell->ch = c;
+    cell->fg = fg_color;
+    cell->bg = bg_color;
+    dirty_rows |= 1u << row;
+}
+
+// Blank cells look the same whatever their foreground color
+static inline int gfx_cell_same(const gfx_cell_t *a, const gfx_cell_t *b) {
+    return a->ch == b->ch && a->bg == b->bg && (a->ch == ' ' || a->fg == b->fg);
+}
+
+// Fill one ring row of a grid with blanks
+static void gfx_cells_blank(gfx_cell_t *row, unsigned short bg) {
+    for (int col = 0; col < SCREEN_COLS; col++) {
+        row[col].ch = ' ';
+        row[col].fg = COLOR_WHITE;
+        row[col].bg = bg;
+    }
+}
+
+// Reset both grids to a blank screen that matches the framebuffer
+static void gfx_cells_reset(unsigned short bg) {
+    cell_base = 0;
+    dirty_rows = 0;
+    for (int row = 0; row < SCREEN_ROWS; row++) {
+        gfx_cells_blank(cells[row], bg);
+        gfx_cells_blank(drawn[row], bg);
+    }
+}
+
+// Simple 8x16 font (ASCII 32-126)
+// Each character is 16 bytes (16 rows of 8 pixels)
+static const unsigned char font_8x16[95][16] = {
+    // Space (32)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // ! (33)
+    {0x00,0x00,0x18,0x3C,0x3C,0x3C,0x18,0x18,0x18,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
+    // " (34)
+    {0x00,0x66,0x66,0x66,0x24,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // # (35)
+    {0x00,0x00,0x00,0x6C,0x6C,0xFE,0x6C,0x6C,0x6C,0xFE,0x6C,0x6C,0x00,0x00,0x00,0x00},
+    // $ (36)
+    {0x18,0x18,0x7C,0xC6,0xC2,0xC0,0x7C,0x06,0x06,0x86,0xC6,0x7C,0x18,0x18,0x00,0x00},
+    // % (37)
+    {0x00,0x00,0x00,0x00,0xC2,0xC6,0x0C,0x18,0x30,0x60,0xC6,0x86,0x00,0x00,0x00,0x00},
+    // & (38)
+    {0x00,0x00,0x38,0x6C,0x6C,0x38,0x76,0xDC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
+    // ' (39)
+    {0x00,0x30,0x30,0x30,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // ( (40)
+    {0x00,0x00,0x0C,0x18,0x30,0x30,0x30,0x30,0x30,0x30,0x18,0x0C,0x00,0x00,0x00,0x00},
+    // ) (41)
+    {0x00,0x00,0x30,0x18,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x18,0x30,0x00,0x00,0x00,0x00},
+    // * (42)
+    {0x00,0x00,0x00,0x00,0x00,0x66,0x3C,0xFF,0x3C,0x66,0x00,0x00,0x00,0x00,0x00,0x00},
+    // + (43)
+    {0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x7E,0x18,0x18,0x00,0x00,0x00,0x00,0x00,0x00},
+    // , (44)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x18,0x30,0x00,0x00,0x00},
+    // - (45)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFE,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // . (46)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
+    // / (47)
+    {0x00,0x00,0x00,0x00,0x02,0x06,0x0C,0x18,0x30,0x60,0xC0,0x80,0x00,0x00,0x00,0x00},
+    // 0 (48)
+    {0x00,0x00,0x38,0x6C,0xC6,0xC6,0xD6,0xD6,0xC6,0xC6,0x6C,0x38,0x00,0x00,0x00,0x00},
+    // 1 (49)
+    {0x00,0x00,0x18,0x38,0x78,0x18,0x18,0x18,0x18,0x18,0x18,0x7E,0x00,0x00,0x00,0x00},
+    // 2 (50)
+    {0x00,0x00,0x7C,0xC6,0x06,0x0C,0x18,0x30,0x60,0xC0,0xC6,0xFE,0x00,0x00,0x00,0x00},
+    // 3 (51)
+    {0x00,0x00,0x7C,0xC6,0x06,0x06,0x3C,0x06,0x06,0x06,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // 4 (52)
+    {0x00,0x00,0x0C,0x1C,0x3C,0x6C,0xCC,0xFE,0x0C,0x0C,0x0C,0x1E,0x00,0x00,0x00,0x00},
+    // 5 (53)
+    {0x00,0x00,0xFE,0xC0,0xC0,0xC0,0xFC,0x06,0x06,0x06,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // 6 (54)
+    {0x00,0x00,0x38,0x60,0xC0,0xC0,0xFC,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // 7 (55)
+    {0x00,0x00,0xFE,0xC6,0x06,0x06,0x0C,0x18,0x30,0x30,0x30,0x30,0x00,0x00,0x00,0x00},
+    // 8 (56)
+    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0x7C,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // 9 (57)
+    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0x7E,0x06,0x06,0x06,0x0C,0x78,0x00,0x00,0x00,0x00},
+    // : (58)
+    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00},
+    // ; (59)
+    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x30,0x00,0x00,0x00,0x00},
+    // < (60)
+    {0x00,0x00,0x00,0x06,0x0C,0x18,0x30,0x60,0x30,0x18,0x0C,0x06,0x00,0x00,0x00,0x00},
+    // = (61)
+    {0x00,0x00,0x00,0x00,0x00,0x7E,0x00,0x00,0x7E,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // > (62)
+    {0x00,0x00,0x00,0x60,0x30,0x18,0x0C,0x06,0x0C,0x18,0x30,0x60,0x00,0x00,0x00,0x00},
+    // ? (63)
+    {0x00,0x00,0x7C,0xC6,0xC6,0x0C,0x18,0x18,0x18,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
+    // @ (64)
+    {0x00,0x00,0x00,0x7C,0xC6,0xC6,0xDE,0xDE,0xDE,0xDC,0xC0,0x7C,0x00,0x00,0x00,0x00},
+    // A (65)
+    {0x00,0x00,0x10,0x38,0x6C,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
+    // B (66)
+    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x66,0x66,0x66,0x66,0xFC,0x00,0x00,0x00,0x00},
+    // C (67)
+    {0x00,0x00,0x3C,0x66,0xC2,0xC0,0xC0,0xC0,0xC0,0xC2,0x66,0x3C,0x00,0x00,0x00,0x00},
+    // D (68)
+    {0x00,0x00,0xF8,0x6C,0x66,0x66,0x66,0x66,0x66,0x66,0x6C,0xF8,0x00,0x00,0x00,0x00},
+    // E (69)
+    {0x00,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00,0x00},
+    // F (70)
+    {0x00,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
+    // G (71)
+    {0x00,0x00,0x3C,0x66,0xC2,0xC0,0xC0,0xDE,0xC6,0xC6,0x66,0x3A,0x00,0x00,0x00,0x00},
+    // H (72)
+    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
+    // I (73)
+    {0x00,0x00,0x3C,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
+    // J (74)
+    {0x00,0x00,0x1E,0x0C,0x0C,0x0C,0x0C,0x0C,0xCC,0xCC,0xCC,0x78,0x00,0x00,0x00,0x00},
+    // K (75)
+    {0x00,0x00,0xE6,0x66,0x66,0x6C,0x78,0x78,0x6C,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
+    // L (76)
+    {0x00,0x00,0xF0,0x60,0x60,0x60,0x60,0x60,0x60,0x62,0x66,0xFE,0x00,0x00,0x00,0x00},
+    // M (77)
+    {0x00,0x00,0xC6,0xEE,0xFE,0xFE,0xD6,0xC6,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
+    // N (78)
+    {0x00,0x00,0xC6,0xE6,0xF6,0xFE,0xDE,0xCE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
+    // O (79)
+    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // P (80)
+    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x60,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
+    // Q (81)
+    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xD6,0xDE,0x7C,0x0C,0x0E,0x00,0x00},
+    // R (82)
+    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x6C,0x66,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
+    // S (83)
+    {0x00,0x00,0x7C,0xC6,0xC6,0x60,0x38,0x0C,0x06,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // T (84)
+    {0x00,0x00,0x7E,0x7E,0x5A,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
+    // U (85)
+    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // V (86)
+    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x6C,0x38,0x10,0x00,0x00,0x00,0x00},
+    // W (87)
+    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xD6,0xD6,0xD6,0xFE,0xEE,0x6C,0x00,0x00,0x00,0x00},
+    // X (88)
+    {0x00,0x00,0xC6,0xC6,0x6C,0x7C,0x38,0x38,0x7C,0x6C,0xC6,0xC6,0x00,0x00,0x00,0x00},
+    // Y (89)
+    {0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
+    // Z (90)
+    {0x00,0x00,0xFE,0xC6,0x86,0x0C,0x18,0x30,0x60,0xC2,0xC6,0xFE,0x00,0x00,0x00,0x00},
+    // [ (91)
+    {0x00,0x00,0x3C,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x3C,0x00,0x00,0x00,0x00},
+    // \ (92)
+    {0x00,0x00,0x00,0x80,0xC0,0xE0,0x70,0x38,0x1C,0x0E,0x06,0x02,0x00,0x00,0x00,0x00},
+    // ] (93)
+    {0x00,0x00,0x3C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x3C,0x00,0x00,0x00,0x00},
+    // ^ (94)
+    {0x10,0x38,0x6C,0xC6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // _ (95)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00},
+    // ` (96)
+    {0x30,0x30,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    // a (97)
+    {0x00,0x00,0x00,0x00,0x00,0x78,0x0C,0x7C,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
+    // b (98)
+    {0x00,0x00,0xE0,0x60,0x60,0x78,0x6C,0x66,0x66,0x66,0x66,0x7C,0x00,0x00,0x00,0x00},
+    // c (99)
+    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xC0,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // d (100)
+    {0x00,0x00,0x1C,0x0C,0x0C,0x3C,0x6C,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
+    // e (101)
+    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // f (102)
+    {0x00,0x00,0x38,0x6C,0x64,0x60,0xF0,0x60,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
+    // g (103)
+    {0x00,0x00,0x00,0x00,0x00,0x76,0xCC,0xCC,0xCC,0xCC,0xCC,0x7C,0x0C,0xCC,0x78,0x00},
+    // h (104)
+    {0x00,0x00,0xE0,0x60,0x60,0x6C,0x76,0x66,0x66,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
+    // i (105)
+    {0x00,0x00,0x18,0x18,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
+    // j (106)
+    {0x00,0x00,0x06,0x06,0x00,0x0E,0x06,0x06,0x06,0x06,0x06,0x06,0x66,0x66,0x3C,0x00},
+    // k (107)
+    {0x00,0x00,0xE0,0x60,0x60,0x66,0x6C,0x78,0x78,0x6C,0x66,0xE6,0x00,0x00,0x00,0x00},
+    // l (108)
+    {0x00,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
+    // m (109)
+    {0x00,0x00,0x00,0x00,0x00,0xEC,0xFE,0xD6,0xD6,0xD6,0xD6,0xC6,0x00,0x00,0x00,0x00},
+    // n (110)
+    {0x00,0x00,0x00,0x00,0x00,0xDC,0x66,0x66,0x66,0x66,0x66,0x66,0x00,0x00,0x00,0x00},
+    // o (111)
+    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // p (112)
+    {0x00,0x00,0x00,0x00,0x00,0xDC,0x66,0x66,0x66,0x66,0x66,0x7C,0x60,0x60,0xF0,0x00},
+    // q (113)
+    {0x00,0x00,0x00,0x00,0x00,0x76,0xCC,0xCC,0xCC,0xCC,0xCC,0x7C,0x0C,0x0C,0x1E,0x00},
+    // r (114)
+    {0x00,0x00,0x00,0x00,0x00,0xDC,0x76,0x66,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
+    // s (115)
+    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0x60,0x38,0x0C,0xC6,0x7C,0x00,0x00,0x00,0x00},
+    // t (116)
+    {0x00,0x00,0x10,0x30,0x30,0xFC,0x30,0x30,0x30,0x30,0x36,0x1C,0x00,0x00,0x00,0x00},
+    // u (117)
+    {0x00,0x00,0x00,0x00,0x00,0xCC,0xCC,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
+    // v (118)
+    {0x00,0x00,0x00,0x00,0x00,0x66,0x66,0x66,0x66,0x66,0x3C,0x18,0x00,0x00,0x00,0x00},
+    // w (119)
+    {0x00,0x00,0x00,0x00,0x00,0xC6,0xC6,0xD6,0xD6,0xD6,0xFE,0x6C,0x00,0x00,0x00,0x00},
+    // x (120)
+    {0x00,0x00,0x00,0x00,0x00,0xC6,0x6C,0x38,0x38,0x38,0x6C,0xC6,0x00,0x00,0x00,0x00},
+    // y (121)
+    {0x00,0x00,0x00,0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7E,0x06,0x0C,0xF8,0x00},
+    // z (122)
+    {0x00,0x00,0x00,0x00,0x00,0xFE,0xCC,0x18,0x30,0x60,0xC6,0xFE,0x00,0x00,0x00,0x00},
+    // { (123)
+    {0x00,0x00,0x0E,0x18,0x18,0x18,0x70,0x18,0x18,0x18,0x18,0x0E,0x00,0x00,0x00,0x00},
+    // | (124)
+    {0x00,0x00,0x18,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x18,0x18,0x00,0x00,0x00,0x00},
+    // } (125)
+    {0x00,0x00,0x70,0x18,0x18,0x18,0x0E,0x18,0x18,0x18,0x18,0x70,0x00,0x00,0x00,0x00},
+    // ~ (126)
+    {0x00,0x00,0x76,0xDC,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+};
+
+// ============================================================================
+// Page Flipping
+// ============================================================================
+
+// Vertical compare fires at the start of vertical sync: the frame that was
+// being scanned when UPBASE was written is finished, so the old page is free
+static void gfx_irq(void) {
+    u32 status = *LCD_MIS;
+    *LCD_ICR = status;
+    if (status & LCD_INT_VCOMP) {
+        flip_pending = 0;
+    }
+}
+
+// Wait until the last flip is on screen. Without the interrupt (some
+// emulators never raise it) one frame time is assumed to be enough.
+static void gfx_wait_flip(void) {
+    while (flip_pending && !timer_expired(flip_deadline)) {
+        thread_sleep_ms(1);
+    }
+    flip_pending = 0;
+}
+
+// Catch a page up with the back buffer's scrolls
+static void gfx_page_scroll(gfx_page_t *p) {
+    int shift = p->scrolls * CHAR_HEIGHT;
+    p->scrolls = 0;
+
+    if (shift >= SCREEN_HEIGHT) {
+        p->top = 0;                     // Every row is damaged anyway
+    } else if (p->top + shift + SCREEN_HEIGHT > FB_HEIGHT) {
+        gfx_copy_words((u32 *)p->base,
+                       (const u32 *)&p->base[(p->top + shift) * gfx_pitch],
+                       (SCREEN_HEIGHT - shift) * gfx_pitch / 4);
+        p->top = 0;
+    } else {
+        p->top += shift;
+    }
+}
+
+// Copy the damaged spans of the back buffer into a page. Each span is
+// claimed before it is copied, so drawing that lands during the copy is
+// either copied now or damages the row again.
+static void gfx_page_update(gfx_page_t *p) {
+    for (int r = 0; r < SCREEN_ROWS; r++) {
+        u32 flags = irq_save();
+        int x0 = p->dx0[r] & ~3;
+        int x1 = p->dx1[r];
+        p->dx1[r] = 0;
+        irq_restore(flags);
+        if (x1 == 0) continue;
+
+        int words = ((x1 - x0 + 3) & ~3) * gfx_bytespp / 4;
+        int off = x0 * gfx_bytespp;
+        int y = r * CHAR_HEIGHT;
+        for (int i = 0; i < CHAR_HEIGHT; i++, y++) {
+            gfx_copy_words((u32 *)&p->base[(p->top + y) * gfx_pitch + off],
+                           (const u32 *)&gfx_row(y)[off], words);
+        }
+    }
+}
+
+void gfx_present(void) {
+    for (;;) {
+        gfx_wait_flip();
+        mutex_lock(&present_lock);
+        if (!flip_pending) break;
+        mutex_unlock(&present_lock);    // Another presenter got there first
+    }
+
+    gfx_page_t *p = &pages[front ^ 1];
+    gfx_page_scroll(p);
+    gfx_page_update(p);
+
+    *LCD_UPBASE = (unsigned int)&p->base[p->top * gfx_pitch];
+    flip_deadline = timer_deadline_us(GFX_FRAME_US);
+    flip_pending = 1;
+    front ^= 1;
+
+    mutex_unlock(&present_lock);
+}
+
+// Present whenever the screen is behind the back buffer
+static void gfx_present_thread(void *arg) {
+    (void)arg;
+    while (1) {
+        u32 flags = irq_save();
+        while (!gfx_page_stale(&pages[front])) {
+            thread_wait(&present_wq);
+        }
+        irq_restore(flags);
+        gfx_present();
+    }
+}
+
+// Initialize the graphics driver in GFX_MODE_RGB565 or GFX_MODE_PAL8
+int gfx_init(int mode) {
+    gfx_mode = mode == GFX_MODE_PAL8 ? GFX_MODE_PAL8 : GFX_MODE_RGB565;
+    gfx_bytespp = gfx_mode / 8;
+    gfx_pitch = SCREEN_WIDTH * gfx_bytespp;
+    expand_valid = 0;
+
+    // Back buffer and pages, sized for this depth
+    fb_bytes = gfx_pitch * FB_HEIGHT;
+    fb_back = kalloc(fb_bytes * (1 + FB_PAGES), FB_ALIGN);
+    if (!fb_back) return -1;
+
+    // Set framebuffer address
+    gfx_pages_reset();
+
+    // Configure timing for 640x480
+    *LCD_TIMING0 = 0x3F1F3F9C;
+    *LCD_TIMING1 = 0x090B61DF;
+    *LCD_TIMING2 = 0x067F1800;
+
+    // Enable LCD: TFT, RGB565 or palettized 8bpp
+    if (gfx_mode == GFX_MODE_PAL8) {
+        gfx_load_palette();
+        *LCD_CONTROL = LCD_CTRL_8BPP | LCD_VCOMP_VSYNC;
+    } else {
+        *LCD_CONTROL = LCD_CTRL_16BPP | LCD_VCOMP_VSYNC;
+    }
+
+    // Clear screen
+    gfx_clear_buffers(bg_color);
+    gfx_cells_reset(bg_color);
+
+    cursor_x = 0;
+    cursor_y = 0;
+    gfx_set_scroll_region(0, text_rows - 1);
+
+    // Flip on vertical sync from a display thread
+    *LCD_ICR = LCD_INT_FUF | LCD_INT_LNBU | LCD_INT_VCOMP | LCD_INT_MBERR;
+    irq_register(IRQ_CLCD, gfx_irq);
+    *LCD_IMSC = LCD_INT_VCOMP;
+    thread_create("gfx", gfx_present_thread, 0, THREAD_PRIO_HIGH);
+    return 0;
+}
+
+// Store a pixel value (see gfx_pixel) at (x, y), clipped
+static inline void gfx_store_pixel(int x, int y, u32 value) {
+    if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
+        if (gfx_mode == GFX_MODE_RGB565) {
+            ((volatile unsigned short *)gfx_row(y))[x] = value;
+        } else {
+            gfx_row(y)[x] = value;
+        }
+    }
+}
+
+// Set pixel at (x, y)
+void gfx_put_pixel(int x, int y, unsigned short color) {
+    gfx_store_pixel(x, y, gfx_pixel(color));
+    gfx_damage(x, x + 1, y, 1);
+}
+
+// Clip a rectangle to the screen; returns 0 if nothing is left
+static int gfx_clip(int *x, int *y, int *w, int *h) {
+    if (*x < 0) { *w += *x; *x = 0; }
+    if (*y < 0) { *h += *y; *y = 0; }
+    if (*x + *w > SCREEN_WIDTH) *w = SCREEN_WIDTH - *x;
+    if (*y + *h > SCREEN_HEIGHT) *h = SCREEN_HEIGHT - *y;
+    return *w > 0 && *h > 0;
+}
+
+// Fill an on-screen rectangle of the back buffer without recording damage.
+// The pixels before the first and after the last whole word are stored
+// one at a time; everything between goes out in bursts.
+static void gfx_fill_area(int x, int y, int w, int h, unsigned short color) {
+    u32 word = gfx_pixel_word(color);
+    int per_word = 4 / gfx_bytespp;
+    int a = (x + per_word - 1) & ~(per_word - 1);
+    int b = (x + w) & ~(per_word - 1);
+    if (a > b) a = b = x + w;
+
+    for (int row = y; row < y + h; row++) {
+        for (int i = x; i < a; i++) gfx_store_pixel(i, row, word);
+        if (b > a) {
+            gfx_fill_words((u32 *)&gfx_row(row)[a * gfx_bytespp], word,
+                           (b - a) / per_word);
+        }
+        for (int i = b; i < x + w; i++) gfx_store_pixel(i, row, word);
+    }
+}
+
+void gfx_fill_rect(int x, int y, int w, int h, unsigned short color) {
+    if (!gfx_clip(&x, &y, &w, &h)) return;
+    gfx_fill_area(x, y, w, h, color);
+    gfx_damage(x, x + w, y, h);
+}
+
+void gfx_hline(int x, int y, int w, unsigned short color) {
+    gfx_fill_rect(x, y, w, 1, color);
+}
+
+// Copy a w x h rectangle from (sx, sy) to (dx, dy) on screen
+// The rectangles may overlap. Rows whose ends share word alignment are
+// copied in bursts; others fall back to memmove.
+void gfx_blit(int dx, int dy, int sx, int sy, int w, int h) {
+    if (sx < 0) { w += sx; dx -= sx; sx = 0; }
+    if (dx < 0) { w += dx; sx -= dx; dx = 0; }
+    if (sy < 0) { h += sy; dy -= sy; sy = 0; }
+    if (dy < 0) { h += dy; sy -= dy; dy = 0; }
+    if (sx + w > SCREEN_WIDTH) w = SCREEN_WIDTH - sx;
+    if (dx + w > SCREEN_WIDTH) w = SCREEN_WIDTH - dx;
+    if (sy + h > SCREEN_HEIGHT) h = SCREEN_HEIGHT - sy;
+    if (dy + h > SCREEN_HEIGHT) h = SCREEN_HEIGHT - dy;
+    if (w <= 0 || h <= 0) return;
+
+    int bytes = w * gfx_bytespp;
+    int bursts = (((dx ^ sx) * gfx_bytespp) & 3) == 0 &&
+                 !(dy == sy && dx > sx);        // Upward copy only
+
+    // Moving down, go bottom-up so overlapping rows are read first
+    int step = dy > sy ? -1 : 1;
+    int r = dy > sy ? h - 1 : 0;
+    for (int i = 0; i < h; i++, r += step) {
+        volatile u8 *d = &gfx_row(dy + r)[dx * gfx_bytespp];
+        volatile u8 *s = &gfx_row(sy + r)[sx * gfx_bytespp];
+        if (!bursts) {
+            memmove((void *)d, (const void *)s, bytes);
+            continue;
+        }
+
+        int head = (4 - ((u32)d & 3)) & 3;
+        if (head > bytes) head = bytes;
+        int words = (bytes - head) / 4;
+        int tail = bytes - head - words * 4;
+        for (int k = 0; k < head; k++) d[k] = s[k];
+        gfx_copy_words((u32 *)(d + head), (const u32 *)(s + head), words);
+        for (int k = bytes - tail; k < bytes; k++) d[k] = s[k];
+    }
+
+    gfx_damage(dx, dx + w, dy, h);
+}
+
+// Draw a font glyph one pixel at a time, clipped, from stored pixel values.
+// Slower than the expansion table but needs no shared state.
+static void gfx_draw_glyph_pixels(int x, int y, const unsigned char *glyph,
+                                  u32 f, u32 b) {
+    for (int row = 0; row < CHAR_HEIGHT; row++) {
+        unsigned char line = glyph[row];
+        for (int col = 0; col < CHAR_WIDTH; col++) {
+            gfx_store_pixel(x + col, y + row, (line & (0x80 >> col)) ? f : b);
+        }
+    }
+}
+
+// Draw a character at pixel position in the given colors
+static void gfx_draw_glyph(int x, int y, unsigned char c,
+                           unsigned short fg, unsigned short bg) {
+    if (c < 32 || c > 126) c = ' ';
+
+    const unsigned char *glyph = font_8x16[c - 32];
+
+    // Fast path: the whole cell is on screen and starts on a word boundary,
+    // so each font row is four 32-bit stores (two at 8bpp) with no clipping
+    int align = gfx_mode == GFX_MODE_RGB565 ? 1 : 3;
+    if ((x & align) == 0 && x >= 0 && x <= SCREEN_WIDTH - CHAR_WIDTH &&
+        y >= 0 && y <= SCREEN_HEIGHT - CHAR_HEIGHT) {
+        gfx_build_expand(fg, bg);
+
+        volatile u32 *dst = (volatile u32 *)&gfx_row(y)[x * gfx_bytespp];
+        if (gfx_mode == GFX_MODE_RGB565) {
+            for (int row = 0; row < CHAR_HEIGHT; row++) {
+                const u32 *hi = glyph_expand[glyph[row] >> 4];
+                const u32 *lo = glyph_expand[glyph[row] & 0xF];
+                dst[0] = hi[0];
+                dst[1] = hi[1];
+                dst[2] = lo[0];
+                dst[3] = lo[1];
+                dst += SCREEN_WIDTH / 2;
+            }
+        } else {
+            for (int row = 0; row < CHAR_HEIGHT; row++) {
+                dst[0] = glyph_expand[glyph[row] >> 4][0];
+                dst[1] = glyph_expand[glyph[row] & 0xF][0];
+                dst += SCREEN_WIDTH / 4;
+            }
+        }
+        return;
+    }
+
+    // Partly off screen or unaligned x: per-pixel with clipping
+    gfx_draw_glyph_pixels(x, y, glyph, gfx_pixel(fg), gfx_pixel(bg));
+}
+
+// Draw a character at pixel position in the current colors
+// This writes pixels directly and bypasses the console cell grid.
+void gfx_draw_char(int x, int y, unsigned char c) {
+    gfx_draw_glyph(x, y, c, fg_color, bg_color);
+    gfx_damage(x, x + CHAR_WIDTH, y, CHAR_HEIGHT);
+}
+
+// Rasterize every cell that differs from what is on screen
+void gfx_flush(void) {
+    while (dirty_rows) {
+        int row = __builtin_ctz(dirty_rows);
+        dirty_rows &= dirty_rows - 1;
+
+        int ring = gfx_ring_row(row);
+        gfx_cell_t *want = cells[ring];
+        gfx_cell_t *have = drawn[ring];
+        int first = -1, last = -1;
+        for (int col = 0; col < SCREEN_COLS; col++) {
+            if (gfx_cell_same(&want[col], &have[col])) continue;
+            if (first < 0) first = col;
+
+            if (want[col].ch != ' ') {
+                gfx_draw_glyph(col * CHAR_WIDTH, row * CHAR_HEIGHT,
+                               want[col].ch, want[col].fg, want[col].bg);
+                have[col] = want[col];
+                last = col;
+                continue;
+            }
+
+            // A run of blanks in one color (cleared lines, erased tails)
+            // is a single rectangle fill
+            int end = col + 1;
+            while (end < SCREEN_COLS && want[end].ch == ' ' &&
+                   want[end].bg == want[col].bg) {
+                end++;
+            }
+            gfx_fill_area(col * CHAR_WIDTH, row * CHAR_HEIGHT,
+                          (end - col) * CHAR_WIDTH, CHAR_HEIGHT, want[col].bg);
+            for (int i = col; i < end; i++) have[i] = want[i];
+            last = end - 1;
+            col = end - 1;
+        }
+        if (first >= 0) {
+            gfx_damage(first * CHAR_WIDTH, (last + 1) * CHAR_WIDTH,
+                       row * CHAR_HEIGHT, CHAR_HEIGHT);
+        }
+    }
+}
+
+// Forget what is on screen so the next flush redraws every cell
+void gfx_invalidate(void) {
+    for (int row = 0; row < SCREEN_ROWS; row++) {
+        for (int col = 0; col < SCREEN_COLS; col++) {
+            drawn[row][col].ch = 0;     // Never a real cell
+        }
+    }
+    dirty_rows = (1u << text_rows) - 1;
+}
+
+// ============================================================================
+// Status Row
+// ============================================================================
+
+// The status row is drawn straight into the back buffer below the console
+// rows. It has no cells, never moves the cursor, and is only redrawn when
+// its text changes or the window scroll carries it away.
+static char status_text[SCREEN_COLS];
+static unsigned short status_fg = COLOR_BLACK;
+static unsigned short status_bg = COLOR_GRAY;
+
+// Draw the status text (present_lock held). Glyphs go out pixel by pixel:
+// the console may be halfway through a flush with the expansion table.
+static void gfx_status_draw(void) {
+    if (text_rows == SCREEN_ROWS) return;
+
+    u32 f = gfx_pixel(status_fg);
+    u32 b = gfx_pixel(status_bg);
+    int y = text_rows * CHAR_HEIGHT;
+    for (int col = 0; col < SCREEN_COLS; col++) {
+        unsigned char c = (unsigned char)status_text[col];
+        if (c < 32 || c > 126) c = ' ';
+        gfx_draw_glyph_pixels(col * CHAR_WIDTH, y, font_8x16[c - 32], f, b);
+    }
+    gfx_damage(0, SCREEN_WIDTH, y, CHAR_HEIGHT);
+}
+
+// Reserve the bottom row for status text; the console keeps the rest
+void gfx_status_enable(unsigned short foreground, unsigned short background) {
+    mutex_lock(&present_lock);
+    text_rows = SCREEN_ROWS - 1;
+    status_fg = foreground;
+    status_bg = background;
+    for (int col = 0; col < SCREEN_COLS; col++) status_text[col] = ' ';
+    gfx_status_draw();
+    mutex_unlock(&present_lock);
+
+    dirty_rows &= (1u << text_rows) - 1;
+    if (cursor_y >= text_rows) cursor_y = text_rows - 1;
+    gfx_set_scroll_region(0, text_rows - 1);
+}
+
+// Replace the status text, padded or cut to the screen width
+void gfx_status_write(const char *s) {
+    mutex_lock(&present_lock);
+    int col = 0;
+    while (col < SCREEN_COLS && s[col]) {
+        status_text[col] = s[col];
+        col++;
+    }
+    while (col < SCREEN_COLS) status_text[col++] = ' ';
+    gfx_status_draw();
+    mutex_unlock(&present_lock);
+}
+
+int gfx_text_rows(void) {
+    return text_rows;
+}
+
+// Scroll screen up by one line
+// The window moves down one text row and only the newly exposed row is
+// cleared. When the window reaches the end of the buffer, the rows that
+// stay visible are copied back to the top once (every 30 scrolls). The
+// pages replay the same moves when they are next presented.
+void gfx_scroll(void) {
+    mutex_lock(&present_lock);
+
+    if (fb_top + SCREEN_HEIGHT + CHAR_HEIGHT > FB_HEIGHT) {
+        gfx_copy_words((u32 *)fb_back, (const u32 *)gfx_row(CHAR_HEIGHT),
+                       (SCREEN_HEIGHT - CHAR_HEIGHT) * gfx_pitch / 4);
+        fb_top = 0;
+    } else {
+        fb_top += CHAR_HEIGHT;
+    }
+
+    // Damage moves up with its rows on every page
+    u32 flags = irq_save();
+    for (int i = 0; i < FB_PAGES; i++) {
+        gfx_page_t *p = &pages[i];
+        for (int r = 0; r < SCREEN_ROWS - 1; r++) {
+            p->dx0[r] = p->dx0[r + 1];
+            p->dx1[r] = p->dx1[r + 1];
+        }
+        p->dx1[SCREEN_ROWS - 1] = 0;
+        p->scrolls++;
+    }
+    irq_restore(flags);
+
+    // The status row went up with the text: move its pixels back down
+    if (text_rows < SCREEN_ROWS) {
+        gfx_blit(0, SCREEN_HEIGHT - CHAR_HEIGHT, 0, SCREEN_HEIGHT - 2 * CHAR_HEIGHT,
+                 SCREEN_WIDTH, CHAR_HEIGHT);
+    }
+
+    // Clear the new bottom line (this damages it on every page)
+    gfx_fill_rect(0, (text_rows - 1) * CHAR_HEIGHT, SCREEN_WIDTH, CHAR_HEIGHT, bg_color);
+
+    mutex_unlock(&present_lock);
+
+    // The grids follow the pixels: rotate the rings and blank the new rows
+    // in both, so pending differences move with their rows
+    cell_base = gfx_ring_row(1);
+    dirty_rows >>= 1;
+    for (int row = text_rows - 1; row < SCREEN_ROWS; row++) {
+        int ring = gfx_ring_row(row);
+        gfx_cells_blank(cells[ring], bg_color);
+        gfx_cells_blank(drawn[ring], bg_color);
+    }
+}
+
+// Copy one grid row over another (screen rows)
+static void gfx_cells_move(int dst, int src) {
+    int d = gfx_ring_row(dst);
+    int s = gfx_ring_row(src);
+    memcpy(cells[d], cells[s], sizeof(cells[0]));
+    memcpy(drawn[d], drawn[s], sizeof(drawn[0]));
+}
+
+// Move screen rows [top, bottom] by n rows, up if n > 0 and down if n < 0,
+// blanking the rows that open up. The pixels move with gfx_blit and the
+// drawn grid moves with them, so the next flush only draws the new rows.
+static void gfx_shift_rows(int top, int bottom, int n) {
+    int height = bottom - top + 1;
+    int up = n > 0;
+    if (n < 0) n = -n;
+    if (n == 0 || height <= 0) return;
+    if (n > height) n = height;
+
+    // The whole screen going up is a window move
+    if (up && top == 0 && bottom == text_rows - 1) {
+        while (n--) gfx_scroll();
+        return;
+    }
+
+    int keep = height - n;
+    if (up) {
+        gfx_blit(0, top * CHAR_HEIGHT, 0, (top + n) * CHAR_HEIGHT,
+                 SCREEN_WIDTH, keep * CHAR_HEIGHT);
+        for (int r = top; r < top + keep; r++) gfx_cells_move(r, r + n);
+        for (int r = top + keep; r <= bottom; r++) {
+            gfx_cells_blank(cells[gfx_ring_row(r)], bg_color);
+        }
+    } else {
+        gfx_blit(0, (top + n) * CHAR_HEIGHT, 0, top * CHAR_HEIGHT,
+                 SCREEN_WIDTH, keep * CHAR_HEIGHT);
+        for (int r = bottom; r >= top + n; r--) gfx_cells_move(r, r - n);
+        for (int r = top; r < top + n; r++) {
+            gfx_cells_blank(cells[gfx_ring_row(r)], bg_color);
+        }
+    }
+
+    // Rows outside the blit kept their pixels, and so their drawn cells
+    dirty_rows |= ((1u << height) - 1) << top;
+}
+
+void gfx_set_scroll_region(int top, int bottom) {
+    if (top < 0) top = 0;
+    if (bottom < 0 || bottom >= text_rows) bottom = text_rows - 1;
+    if (top >= bottom) {
+        top = 0;
+        bottom = text_rows - 1;
+    }
+    region_top = top;
+    region_bottom = bottom;
+}
+
+// Move down a row, scrolling the region at its bottom margin
+void gfx_linefeed(void) {
+    if (cursor_y == region_bottom) {
+        gfx_shift_rows(region_top, region_bottom, 1);
+    } else if (cursor_y < text_rows - 1) {
+        cursor_y++;
+    }
+}
+
+// Move up a row, scrolling the region down at its top margin
+void gfx_reverse_index(void) {
+    if (cursor_y == region_top) {
+        gfx_shift_rows(region_top, region_bottom, -1);
+    } else if (cursor_y > 0) {
+        cursor_y--;
+    }
+}
+
+void gfx_scroll_region(int n) {
+    gfx_shift_rows(region_top, region_bottom, n);
+}
+
+// Insert n blank lines at the cursor row, pushing the rest of the region down
+void gfx_insert_lines(int n) {
+    if (cursor_y < region_top || cursor_y > region_bottom) return;
+    gfx_shift_rows(cursor_y, region_bottom, -n);
+    cursor_x = 0;
+}
+
+// Delete n lines at the cursor row, pulling the rest of the region up
+void gfx_delete_lines(int n) {
+    if (cursor_y < region_top || cursor_y > region_bottom) return;
+    gfx_shift_rows(cursor_y, region_bottom, n);
+    cursor_x = 0;
+}
+
+// Print a character (handles cursor, newlines, scrolling)
+void gfx_putchar(unsigned char c) {
+    if (c == '\n') {
+        cursor_x = 0;
+        gfx_linefeed();
+    } else if (c == '\r') {
+        cursor_x = 0;
+    } else if (c == '\b') {
+        if (cursor_x > 0) {
+            cursor_x--;
+            gfx_cell_put(cursor_x, cursor_y, ' ');
+        }
+    } else {
+        gfx_cell_put(cursor_x, cursor_y, c);
+        cursor_x++;
+
+        if (cursor_x >= SCREEN_COLS) {
+            cursor_x = 0;
+            gfx_linefeed();
+        }
+    }
+}
+
+// Write n characters into the cell grid
+// Printable runs go straight across the row; the cursor and scroll checks
+// happen once per run instead of once per glyph. Call gfx_flush() to draw.
+void gfx_write(const char *s, int n) {
+    while (n > 0) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '\n' || c == '\r' || c == '\b') {
+            gfx_putchar(c);
+            s++;
+            n--;
+            continue;
+        }
+
+        gfx_cell_t *cell = &cells[gfx_ring_row(cursor_y)][cursor_x];
+        int room = SCREEN_COLS - cursor_x;
+        int k = 0;
+        while (k < n && k < room) {
+            c = (unsigned char)s[k];
+            if (c == '\n' || c == '\r' || c == '\b') break;
+            cell->ch = c;
+            cell->fg = fg_color;
+            cell->bg = bg_color;
+            cell++;
+            k++;
+        }
+        if (k > 0) dirty_rows |= 1u << cursor_y;
+
+        cursor_x += k;
+        s += k;
+        n -= k;
+
+        if (cursor_x >= SCREEN_COLS) {
+            cursor_x = 0;
+            gfx_linefeed();
+        }
+    }
+}
+
+// Print a string
+void gfx_print(const char *s) {
+    gfx_write(s, strlen(s));
+}
+
+// Clear screen (always clears to black for consistency)
+// Only the cells that were not already blank get redrawn on the next flush.
+void gfx_clear(void) {
+    for (int row = 0; row < SCREEN_ROWS; row++) {
+        gfx_cells_blank(cells[row], COLOR_BLACK);
+    }
+    dirty_rows = (1u << text_rows) - 1;
+    cursor_x = 0;
+    cursor_y = 0;
+    // Also reset colors when clearing
+    fg_color = COLOR_WHITE;
+    bg_color = COLOR_BLACK;
+}
+
+// Set cursor position (0-indexed)
+void gfx_set_cursor(int x, int y) {
+    if (x >= 0 && x < SCREEN_COLS) cursor_x = x;
+    if (y >= 0 && y < text_rows) cursor_y = y;
+}
+
+void gfx_get_cursor(int *x, int *y) {
+    *x = cursor_x;
+    *y = cursor_y;
+}
+
+// Blank cells [from, to) of a row in the current bg color
+static void gfx_clear_cells(int row, int from, int to) {
+    for (int x = from; x < to; x++) {
+        gfx_cell_put(x, row, ' ');
+    }
+}
+
+// Clear from cursor to end of line (uses current bg color)
+void gfx_clear_to_eol(void) {
+    gfx_clear_cells(cursor_y, cursor_x, SCREEN_COLS);
+}
+
+// Clear from start of line through the cursor
+void gfx_clear_to_bol(void) {
+    gfx_clear_cells(cursor_y, 0, cursor_x + 1 < SCREEN_COLS ? cursor_x + 1 : SCREEN_COLS);
+}
+
+void gfx_clear_line(void) {
+    gfx_clear_cells(cursor_y, 0, SCREEN_COLS);
+}
+
+// Clear from cursor to end of screen
+void gfx_clear_to_eos(void) {
+    gfx_clear_to_eol();
+    for (int row = cursor_y + 1; row < text_rows; row++) {
+        gfx_clear_cells(row, 0, SCREEN_COLS);
+    }
+}
+
+// Clear from start of screen through the cursor
+void gfx_clear_to_bos(void) {
+    for (int row = 0; row < cursor_y; row++) {
+        gfx_clear_cells(row, 0, SCREEN_COLS);
+    }
+    gfx_clear_to_bol();
+}
+
+// Set colors
+void gfx_set_colors(unsigned short foreground, unsigned short background) {
+    fg_color = foreground;
+    bg_color = background;
+}
+
+// Reset graphics to default state
+void gfx_reset(void) {
+    fg_color = COLOR_WHITE;
+    bg_color = COLOR_BLACK;
+    cursor_x = 0;
+    cursor_y = 0;
+    gfx_set_scroll_region(0, text_rows - 1);
+}
+
+// Full screen reset - clear to black and reset all state
+void gfx_full_reset(void) {
+    fg_color = COLOR_WHITE;
+    bg_color = COLOR_BLACK;
+    mutex_lock(&present_lock);
+    gfx_wait_flip();
+    gfx_pages_reset();
+    gfx_clear_buffers(COLOR_BLACK);
+    gfx_status_draw();
+    mutex_unlock(&present_lock);
+    gfx_cells_reset(COLOR_BLACK);
+    cursor_x = 0;
+    cursor_y = 0;
+    gfx_set_scroll_region(0, text_rows - 1);
+}
+
+#endif // CONFIG_GRAPHICS
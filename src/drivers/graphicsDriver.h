@@ -15,14 +15,50 @@
 #define LCD_LPBASE      ((volatile unsigned int*)(LCD_BASE + 0x14))
 #define LCD_CONTROL     ((volatile unsigned int*)(LCD_BASE + 0x18))
 #define LCD_IMSC        ((volatile unsigned int*)(LCD_BASE + 0x1C))
+#define LCD_RIS         ((volatile unsigned int*)(LCD_BASE + 0x20))
+#define LCD_MIS         ((volatile unsigned int*)(LCD_BASE + 0x24))
+#define LCD_ICR         ((volatile unsigned int*)(LCD_BASE + 0x28))
+#define LCD_PALETTE     ((volatile unsigned int*)(LCD_BASE + 0x200))
+
+// LCD_CONTROL: power on, TFT, enable, and the pixel depth
+#define LCD_CTRL_16BPP  0x00000829
+#define LCD_CTRL_8BPP   0x00000827
+
+// LCD_CONTROL: when the vertical compare interrupt fires
+#define LCD_VCOMP_VSYNC     (0 << 12)   // Start of vertical sync
+#define LCD_VCOMP_MASK      (3 << 12)
+
+// Interrupt bits (IMSC/RIS/MIS/ICR)
+#define LCD_INT_FUF     (1 << 1)    // FIFO underflow
+#define LCD_INT_LNBU    (1 << 2)    // Base address latched
+#define LCD_INT_VCOMP   (1 << 3)    // Vertical compare
+#define LCD_INT_MBERR   (1 << 4)    // Bus error
 
 // Screen dimensions
 #define SCREEN_WIDTH    640
 #define SCREEN_HEIGHT   480
-#define SCREEN_BPP      16      // 16 bits per pixel (RGB565)
-
-// Framebuffer location (place it after kernel in memory)
-#define FRAMEBUFFER     ((volatile unsigned short*)0x200000)
+#define SCREEN_BPP      16      // Deepest mode (RGB565); sizes the buffers
+
+// Pixel depths for gfx_init(). Colors are always given as RGB565; in the
+// 8-bit mode they are mapped onto a fixed palette, which halves the bytes
+// every clear, glyph and scroll has to move.
+#define GFX_MODE_RGB565 16
+#define GFX_MODE_PAL8   8
+
+// Framebuffers
+// gfx_init() allocates them from the heap at the mode's depth. Drawing goes
+// to the back buffer, which is never scanned out. The LCD shows one of
+// FB_PAGES pages that follow it; gfx_present() brings the hidden page up
+// to date and flips to it at vertical sync.
+// Every buffer is twice the screen height: the visible part is a 480-row
+// window starting at the buffer's top row, and scrolling moves it down.
+#define FB_HEIGHT       (SCREEN_HEIGHT * 2)
+#define FB_BYTES        (SCREEN_WIDTH * FB_HEIGHT * (SCREEN_BPP / 8))   // Per buffer, at most
+#define FB_PAGES        2
+#define FB_ALIGN        32      // One burst; PL110 needs 8
+
+// Fallback frame time when the vertical compare interrupt never arrives
+#define GFX_FRAME_US    16667
 
 // Colors (RGB565 format)
 #define COLOR_BLACK     0x0000
@@ -36,360 +72,68 @@
 #define COLOR_GRAY      0x8410
 #define COLOR_DARKGRAY  0x4208
 
-// Current colors
-static unsigned short fg_color = COLOR_WHITE;
-static unsigned short bg_color = COLOR_BLACK;
-
-// Cursor position (in character cells)
-static int cursor_x = 0;
-static int cursor_y = 0;
-
 // Character dimensions
 #define CHAR_WIDTH      8
 #define CHAR_HEIGHT     16
 #define SCREEN_COLS     (SCREEN_WIDTH / CHAR_WIDTH)    // 80
 #define SCREEN_ROWS     (SCREEN_HEIGHT / CHAR_HEIGHT)  // 30
 
-// Simple 8x16 font (ASCII 32-126)
-// Each character is 16 bytes (16 rows of 8 pixels)
-static const unsigned char font_8x16[95][16] = {
-    // Space (32)
-    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // ! (33)
-    {0x00,0x00,0x18,0x3C,0x3C,0x3C,0x18,0x18,0x18,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
-    // " (34)
-    {0x00,0x66,0x66,0x66,0x24,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // # (35)
-    {0x00,0x00,0x00,0x6C,0x6C,0xFE,0x6C,0x6C,0x6C,0xFE,0x6C,0x6C,0x00,0x00,0x00,0x00},
-    // $ (36)
-    {0x18,0x18,0x7C,0xC6,0xC2,0xC0,0x7C,0x06,0x06,0x86,0xC6,0x7C,0x18,0x18,0x00,0x00},
-    // % (37)
-    {0x00,0x00,0x00,0x00,0xC2,0xC6,0x0C,0x18,0x30,0x60,0xC6,0x86,0x00,0x00,0x00,0x00},
-    // & (38)
-    {0x00,0x00,0x38,0x6C,0x6C,0x38,0x76,0xDC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
-    // ' (39)
-    {0x00,0x30,0x30,0x30,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // ( (40)
-    {0x00,0x00,0x0C,0x18,0x30,0x30,0x30,0x30,0x30,0x30,0x18,0x0C,0x00,0x00,0x00,0x00},
-    // ) (41)
-    {0x00,0x00,0x30,0x18,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x18,0x30,0x00,0x00,0x00,0x00},
-    // * (42)
-    {0x00,0x00,0x00,0x00,0x00,0x66,0x3C,0xFF,0x3C,0x66,0x00,0x00,0x00,0x00,0x00,0x00},
-    // + (43)
-    {0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x7E,0x18,0x18,0x00,0x00,0x00,0x00,0x00,0x00},
-    // , (44)
-    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x18,0x30,0x00,0x00,0x00},
-    // - (45)
-    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFE,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // . (46)
-    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
-    // / (47)
-    {0x00,0x00,0x00,0x00,0x02,0x06,0x0C,0x18,0x30,0x60,0xC0,0x80,0x00,0x00,0x00,0x00},
-    // 0 (48)
-    {0x00,0x00,0x38,0x6C,0xC6,0xC6,0xD6,0xD6,0xC6,0xC6,0x6C,0x38,0x00,0x00,0x00,0x00},
-    // 1 (49)
-    {0x00,0x00,0x18,0x38,0x78,0x18,0x18,0x18,0x18,0x18,0x18,0x7E,0x00,0x00,0x00,0x00},
-    // 2 (50)
-    {0x00,0x00,0x7C,0xC6,0x06,0x0C,0x18,0x30,0x60,0xC0,0xC6,0xFE,0x00,0x00,0x00,0x00},
-    // 3 (51)
-    {0x00,0x00,0x7C,0xC6,0x06,0x06,0x3C,0x06,0x06,0x06,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // 4 (52)
-    {0x00,0x00,0x0C,0x1C,0x3C,0x6C,0xCC,0xFE,0x0C,0x0C,0x0C,0x1E,0x00,0x00,0x00,0x00},
-    // 5 (53)
-    {0x00,0x00,0xFE,0xC0,0xC0,0xC0,0xFC,0x06,0x06,0x06,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // 6 (54)
-    {0x00,0x00,0x38,0x60,0xC0,0xC0,0xFC,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // 7 (55)
-    {0x00,0x00,0xFE,0xC6,0x06,0x06,0x0C,0x18,0x30,0x30,0x30,0x30,0x00,0x00,0x00,0x00},
-    // 8 (56)
-    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0x7C,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // 9 (57)
-    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0x7E,0x06,0x06,0x06,0x0C,0x78,0x00,0x00,0x00,0x00},
-    // : (58)
-    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00},
-    // ; (59)
-    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x30,0x00,0x00,0x00,0x00},
-    // < (60)
-    {0x00,0x00,0x00,0x06,0x0C,0x18,0x30,0x60,0x30,0x18,0x0C,0x06,0x00,0x00,0x00,0x00},
-    // = (61)
-    {0x00,0x00,0x00,0x00,0x00,0x7E,0x00,0x00,0x7E,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // > (62)
-    {0x00,0x00,0x00,0x60,0x30,0x18,0x0C,0x06,0x0C,0x18,0x30,0x60,0x00,0x00,0x00,0x00},
-    // ? (63)
-    {0x00,0x00,0x7C,0xC6,0xC6,0x0C,0x18,0x18,0x18,0x00,0x18,0x18,0x00,0x00,0x00,0x00},
-    // @ (64)
-    {0x00,0x00,0x00,0x7C,0xC6,0xC6,0xDE,0xDE,0xDE,0xDC,0xC0,0x7C,0x00,0x00,0x00,0x00},
-    // A (65)
-    {0x00,0x00,0x10,0x38,0x6C,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
-    // B (66)
-    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x66,0x66,0x66,0x66,0xFC,0x00,0x00,0x00,0x00},
-    // C (67)
-    {0x00,0x00,0x3C,0x66,0xC2,0xC0,0xC0,0xC0,0xC0,0xC2,0x66,0x3C,0x00,0x00,0x00,0x00},
-    // D (68)
-    {0x00,0x00,0xF8,0x6C,0x66,0x66,0x66,0x66,0x66,0x66,0x6C,0xF8,0x00,0x00,0x00,0x00},
-    // E (69)
-    {0x00,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00,0x00},
-    // F (70)
-    {0x00,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
-    // G (71)
-    {0x00,0x00,0x3C,0x66,0xC2,0xC0,0xC0,0xDE,0xC6,0xC6,0x66,0x3A,0x00,0x00,0x00,0x00},
-    // H (72)
-    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
-    // I (73)
-    {0x00,0x00,0x3C,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
-    // J (74)
-    {0x00,0x00,0x1E,0x0C,0x0C,0x0C,0x0C,0x0C,0xCC,0xCC,0xCC,0x78,0x00,0x00,0x00,0x00},
-    // K (75)
-    {0x00,0x00,0xE6,0x66,0x66,0x6C,0x78,0x78,0x6C,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
-    // L (76)
-    {0x00,0x00,0xF0,0x60,0x60,0x60,0x60,0x60,0x60,0x62,0x66,0xFE,0x00,0x00,0x00,0x00},
-    // M (77)
-    {0x00,0x00,0xC6,0xEE,0xFE,0xFE,0xD6,0xC6,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
-    // N (78)
-    {0x00,0x00,0xC6,0xE6,0xF6,0xFE,0xDE,0xCE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00,0x00},
-    // O (79)
-    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // P (80)
-    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x60,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
-    // Q (81)
-    {0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xD6,0xDE,0x7C,0x0C,0x0E,0x00,0x00},
-    // R (82)
-    {0x00,0x00,0xFC,0x66,0x66,0x66,0x7C,0x6C,0x66,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
-    // S (83)
-    {0x00,0x00,0x7C,0xC6,0xC6,0x60,0x38,0x0C,0x06,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // T (84)
-    {0x00,0x00,0x7E,0x7E,0x5A,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
-    // U (85)
-    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // V (86)
-    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x6C,0x38,0x10,0x00,0x00,0x00,0x00},
-    // W (87)
-    {0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xD6,0xD6,0xD6,0xFE,0xEE,0x6C,0x00,0x00,0x00,0x00},
-    // X (88)
-    {0x00,0x00,0xC6,0xC6,0x6C,0x7C,0x38,0x38,0x7C,0x6C,0xC6,0xC6,0x00,0x00,0x00,0x00},
-    // Y (89)
-    {0x00,0x00,0x66,0x66,0x66,0x66,0x3C,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
-    // Z (90)
-    {0x00,0x00,0xFE,0xC6,0x86,0x0C,0x18,0x30,0x60,0xC2,0xC6,0xFE,0x00,0x00,0x00,0x00},
-    // [ (91)
-    {0x00,0x00,0x3C,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x3C,0x00,0x00,0x00,0x00},
-    // \ (92)
-    {0x00,0x00,0x00,0x80,0xC0,0xE0,0x70,0x38,0x1C,0x0E,0x06,0x02,0x00,0x00,0x00,0x00},
-    // ] (93)
-    {0x00,0x00,0x3C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x0C,0x3C,0x00,0x00,0x00,0x00},
-    // ^ (94)
-    {0x10,0x38,0x6C,0xC6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // _ (95)
-    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00},
-    // ` (96)
-    {0x30,0x30,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-    // a (97)
-    {0x00,0x00,0x00,0x00,0x00,0x78,0x0C,0x7C,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
-    // b (98)
-    {0x00,0x00,0xE0,0x60,0x60,0x78,0x6C,0x66,0x66,0x66,0x66,0x7C,0x00,0x00,0x00,0x00},
-    // c (99)
-    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xC0,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // d (100)
-    {0x00,0x00,0x1C,0x0C,0x0C,0x3C,0x6C,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
-    // e (101)
-    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // f (102)
-    {0x00,0x00,0x38,0x6C,0x64,0x60,0xF0,0x60,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
-    // g (103)
-    {0x00,0x00,0x00,0x00,0x00,0x76,0xCC,0xCC,0xCC,0xCC,0xCC,0x7C,0x0C,0xCC,0x78,0x00},
-    // h (104)
-    {0x00,0x00,0xE0,0x60,0x60,0x6C,0x76,0x66,0x66,0x66,0x66,0xE6,0x00,0x00,0x00,0x00},
-    // i (105)
-    {0x00,0x00,0x18,0x18,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
-    // j (106)
-    {0x00,0x00,0x06,0x06,0x00,0x0E,0x06,0x06,0x06,0x06,0x06,0x06,0x66,0x66,0x3C,0x00},
-    // k (107)
-    {0x00,0x00,0xE0,0x60,0x60,0x66,0x6C,0x78,0x78,0x6C,0x66,0xE6,0x00,0x00,0x00,0x00},
-    // l (108)
-    {0x00,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00,0x00},
-    // m (109)
-    {0x00,0x00,0x00,0x00,0x00,0xEC,0xFE,0xD6,0xD6,0xD6,0xD6,0xC6,0x00,0x00,0x00,0x00},
-    // n (110)
-    {0x00,0x00,0x00,0x00,0x00,0xDC,0x66,0x66,0x66,0x66,0x66,0x66,0x00,0x00,0x00,0x00},
-    // o (111)
-    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // p (112)
-    {0x00,0x00,0x00,0x00,0x00,0xDC,0x66,0x66,0x66,0x66,0x66,0x7C,0x60,0x60,0xF0,0x00},
-    // q (113)
-    {0x00,0x00,0x00,0x00,0x00,0x76,0xCC,0xCC,0xCC,0xCC,0xCC,0x7C,0x0C,0x0C,0x1E,0x00},
-    // r (114)
-    {0x00,0x00,0x00,0x00,0x00,0xDC,0x76,0x66,0x60,0x60,0x60,0xF0,0x00,0x00,0x00,0x00},
-    // s (115)
-    {0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0x60,0x38,0x0C,0xC6,0x7C,0x00,0x00,0x00,0x00},
-    // t (116)
-    {0x00,0x00,0x10,0x30,0x30,0xFC,0x30,0x30,0x30,0x30,0x36,0x1C,0x00,0x00,0x00,0x00},
-    // u (117)
-    {0x00,0x00,0x00,0x00,0x00,0xCC,0xCC,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00,0x00},
-    // v (118)
-    {0x00,0x00,0x00,0x00,0x00,0x66,0x66,0x66,0x66,0x66,0x3C,0x18,0x00,0x00,0x00,0x00},
-    // w (119)
-    {0x00,0x00,0x00,0x00,0x00,0xC6,0xC6,0xD6,0xD6,0xD6,0xFE,0x6C,0x00,0x00,0x00,0x00},
-    // x (120)
-    {0x00,0x00,0x00,0x00,0x00,0xC6,0x6C,0x38,0x38,0x38,0x6C,0xC6,0x00,0x00,0x00,0x00},
-    // y (121)
-    {0x00,0x00,0x00,0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7E,0x06,0x0C,0xF8,0x00},
-    // z (122)
-    {0x00,0x00,0x00,0x00,0x00,0xFE,0xCC,0x18,0x30,0x60,0xC6,0xFE,0x00,0x00,0x00,0x00},
-    // { (123)
-    {0x00,0x00,0x0E,0x18,0x18,0x18,0x70,0x18,0x18,0x18,0x18,0x0E,0x00,0x00,0x00,0x00},
-    // | (124)
-    {0x00,0x00,0x18,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x18,0x18,0x00,0x00,0x00,0x00},
-    // } (125)
-    {0x00,0x00,0x70,0x18,0x18,0x18,0x0E,0x18,0x18,0x18,0x18,0x70,0x00,0x00,0x00,0x00},
-    // ~ (126)
-    {0x00,0x00,0x76,0xDC,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
-};
-
-// Initialize the graphics driver
-static void gfx_init(void) {
-    // Set framebuffer address
-    *LCD_UPBASE = (unsigned int)FRAMEBUFFER;
-
-    // Configure timing for 640x480
-    *LCD_TIMING0 = 0x3F1F3F9C;
-    *LCD_TIMING1 = 0x090B61DF;
-    *LCD_TIMING2 = 0x067F1800;
-
-    // Enable LCD: RGB565, TFT, enabled
-    *LCD_CONTROL = 0x00000829;  // Power on, BGR, TFT, 16bpp, enable
-
-    // Clear screen
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        FRAMEBUFFER[i] = bg_color;
-    }
-
-    cursor_x = 0;
-    cursor_y = 0;
-}
-
-// Set pixel at (x, y)
-static void gfx_put_pixel(int x, int y, unsigned short color) {
-    if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-        FRAMEBUFFER[y * SCREEN_WIDTH + x] = color;
-    }
-}
-
-// Draw a character at pixel position
-static void gfx_draw_char(int x, int y, unsigned char c) {
-    if (c < 32 || c > 126) c = ' ';
-
-    const unsigned char *glyph = font_8x16[c - 32];
-
-    for (int row = 0; row < CHAR_HEIGHT; row++) {
-        unsigned char line = glyph[row];
-        for (int col = 0; col < CHAR_WIDTH; col++) {
-            unsigned short color = (line & (0x80 >> col)) ? fg_color : bg_color;
-            gfx_put_pixel(x + col, y + row, color);
-        }
-    }
-}
-
-// Scroll screen up by one line
-static void gfx_scroll(void) {
-    // Move everything up by one character row
-    for (int y = 0; y < SCREEN_HEIGHT - CHAR_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            FRAMEBUFFER[y * SCREEN_WIDTH + x] = FRAMEBUFFER[(y + CHAR_HEIGHT) * SCREEN_WIDTH + x];
-        }
-    }
-
-    // Clear the bottom line
-    for (int y = SCREEN_HEIGHT - CHAR_HEIGHT; y < SCREEN_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            FRAMEBUFFER[y * SCREEN_WIDTH + x] = bg_color;
-        }
-    }
-}
-
-// Print a character (handles cursor, newlines, scrolling)
-static void gfx_putchar(unsigned char c) {
-    if (c == '\n') {
-        cursor_x = 0;
-        cursor_y++;
-    } else if (c == '\r') {
-        cursor_x = 0;
-    } else if (c == '\b') {
-        if (cursor_x > 0) {
-            cursor_x--;
-            gfx_draw_char(cursor_x * CHAR_WIDTH, cursor_y * CHAR_HEIGHT, ' ');
-        }
-    } else {
-        gfx_draw_char(cursor_x * CHAR_WIDTH, cursor_y * CHAR_HEIGHT, c);
-        cursor_x++;
-
-        if (cursor_x >= SCREEN_COLS) {
-            cursor_x = 0;
-            cursor_y++;
-        }
-    }
-
-    // Scroll if needed
-    if (cursor_y >= SCREEN_ROWS) {
-        gfx_scroll();
-        cursor_y = SCREEN_ROWS - 1;
-    }
-}
-
-// Print a string
-static void gfx_print(const char *s) {
-    while (*s) {
-        gfx_putchar(*s++);
-    }
-}
-
-// Clear screen (always clears to black for consistency)
-static void gfx_clear(void) {
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        FRAMEBUFFER[i] = COLOR_BLACK;
-    }
-    cursor_x = 0;
-    cursor_y = 0;
-    // Also reset colors when clearing
-    fg_color = COLOR_WHITE;
-    bg_color = COLOR_BLACK;
-}
-
-// Set cursor position (0-indexed)
-static void gfx_set_cursor(int x, int y) {
-    if (x >= 0 && x < SCREEN_COLS) cursor_x = x;
-    if (y >= 0 && y < SCREEN_ROWS) cursor_y = y;
-}
-
-// Clear from cursor to end of line (uses current bg color)
-static void gfx_clear_to_eol(void) {
-    for (int x = cursor_x; x < SCREEN_COLS; x++) {
-        gfx_draw_char(x * CHAR_WIDTH, cursor_y * CHAR_HEIGHT, ' ');
-    }
-}
-
-// Set colors
-static void gfx_set_colors(unsigned short foreground, unsigned short background) {
-    fg_color = foreground;
-    bg_color = background;
-}
-
-// Reset graphics to default state
-static void gfx_reset(void) {
-    fg_color = COLOR_WHITE;
-    bg_color = COLOR_BLACK;
-    cursor_x = 0;
-    cursor_y = 0;
-}
-
-// Full screen reset - clear to black and reset all state
-static void gfx_full_reset(void) {
-    fg_color = COLOR_WHITE;
-    bg_color = COLOR_BLACK;
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        FRAMEBUFFER[i] = COLOR_BLACK;
-    }
-    cursor_x = 0;
-    cursor_y = 0;
-}
+// Console
+// Text goes into an 80x30 cell grid; gfx_flush() draws the cells that
+// changed since the last flush.
+// gfx_init() returns -1, leaving the LCD off, if the buffers do not fit.
+int gfx_init(int mode);
+void gfx_putchar(unsigned char c);
+void gfx_print(const char *s);
+void gfx_write(const char *s, int n);
+void gfx_clear(void);
+void gfx_set_cursor(int x, int y);
+void gfx_clear_to_eol(void);
+void gfx_set_colors(unsigned short foreground, unsigned short background);
+void gfx_reset(void);
+void gfx_full_reset(void);
+void gfx_flush(void);
+void gfx_invalidate(void);
+void gfx_get_cursor(int *x, int *y);
+
+// VT100 editing. Rows are 0-indexed and inclusive. Line feeds on the
+// bottom row of the scroll region scroll only the region; region scrolls
+// move pixels with gfx_blit (or the window, for the full screen) so only
+// the exposed rows are drawn.
+void gfx_set_scroll_region(int top, int bottom);
+void gfx_linefeed(void);
+void gfx_reverse_index(void);
+void gfx_scroll_region(int n);          // n > 0: up, n < 0: down
+void gfx_insert_lines(int n);
+void gfx_delete_lines(int n);
+void gfx_clear_to_bol(void);
+void gfx_clear_line(void);
+void gfx_clear_to_eos(void);
+void gfx_clear_to_bos(void);
+
+// Status row. Enabling it takes the bottom row away from the console, which
+// then has gfx_text_rows() rows; the text is drawn on its own and never
+// touches the cells, cursor or colors of the console.
+void gfx_status_enable(unsigned short foreground, unsigned short background);
+void gfx_status_write(const char *s);
+int gfx_text_rows(void);
+
+// Show what has been drawn so far. Waits for the previous flip to reach
+// the screen; a display thread calls this whenever there is new damage.
+void gfx_present(void);
+
+// Drawing
+// Rectangles are clipped to the screen. Fills and copies run as word
+// bursts (see graphicsBurst.s) wherever the rows allow it.
+void gfx_put_pixel(int x, int y, unsigned short color);
+void gfx_draw_char(int x, int y, unsigned char c);
+void gfx_fill_rect(int x, int y, int w, int h, unsigned short color);
+void gfx_hline(int x, int y, int w, unsigned short color);
+void gfx_blit(int dx, int dy, int sx, int sy, int w, int h);
+void gfx_scroll(void);
+
+// Burst loops (graphicsBurst.s); counts are in words
+void gfx_fill_words(u32 *dst, u32 word, u32 count);
+void gfx_copy_words(u32 *dst, const u32 *src, u32 count);
 
 #endif
@@ -0,0 +1,660 @@
+/*
+ * PL181 SD/MMC Controller Driver for VersatilePB
+ */
+
+#include "pl181_sd.h"
+#include "timer.h"
+#include <sys/coroutine.h>
+#include <sys/irq.h>
+#include <sys/klog.h>
+
+// Timeouts (microseconds)
+#define SD_POWER_RAMP_US        1000        // Supply ramp / 74 init clocks
+#define SD_OP_COND_TIMEOUT_US   1000000     // ACMD41 must finish within 1 s
+#define SD_OP_COND_POLL_US      1000        // ACMD41 retry interval
+#define SD_CMD_TIMEOUT_US       10000       // Command response
+#define SD_DATA_TIMEOUT_US      100000      // Read data / data end
+#define SD_WRITE_TIMEOUT_US     250000      // Block programming
+#define SD_ERASE_TIMEOUT_US     30000000    // Erase of a large range
+
+// Initialization state machine
+typedef enum {
+    SD_INIT_OFF,            // Controller powered down
+    SD_INIT_POWER_UP,       // Waiting for supply ramp
+    SD_INIT_CLOCK_RAMP,     // Clocking the card before CMD0
+    SD_INIT_OP_COND,        // Polling ACMD41 until the card is ready
+    SD_INIT_IDENTIFY,       // CID/RCA/CSD/select/bus setup
+    SD_INIT_READY,          // Card in transfer state
+    SD_INIT_FAILED
+} sd_init_state_t;
+
+// Global state
+static sd_init_state_t sd_state = SD_INIT_OFF;
+static u32 sd_deadline = 0;           // Earliest time the current step may run
+static u32 sd_op_cond_deadline = 0;   // Give up on ACMD41 after this
+static u32 sd_ocr_arg = 0;            // ACMD41 argument chosen from CMD8
+static int sd_initialized = 0;
+static u32 sd_rca = 0;  // Relative Card Address
+static int sd_high_capacity = 0;  // SDHC/SDXC: commands take block addresses
+static u32 sd_csd[4];             // Raw CSD, sd_csd[0] holds bits 127:96
+static u32 sd_capacity = 0;       // Card size in 512-byte sectors
+static u8 sd_scr[8];              // Raw SCR, MSB first
+static u32 sd_max_hz = 0;         // Rated transfer speed (CSD TRAN_SPEED)
+static u32 sd_clock_hz = 0;       // Negotiated bus clock
+static int sd_bus_width = 1;      // Negotiated data bus width (1 or 4)
+static volatile int sd_busy = 0;  // A transfer owns the controller
+
+// Send command and wait for response
+static int sd_send_cmd(u32 cmd, u32 arg, int response) {
+    // Clear status flags
+    *MMCI_CLEAR = 0x7FF;
+
+    // Set argument
+    *MMCI_ARGUMENT = arg;
+
+    // Build command register value
+    u32 cmd_reg = (cmd & 0x3F) | MMCI_CMD_ENABLE;
+    if (response) {
+        cmd_reg |= MMCI_CMD_RESPONSE;
+    }
+    if (response == SD_RESP_LONG) {
+        cmd_reg |= MMCI_CMD_LONGRESP;
+    }
+
+    // Send command
+    *MMCI_COMMAND = cmd_reg;
+
+    // Wait for command to complete
+    u32 deadline = timer_deadline_us(SD_CMD_TIMEOUT_US);
+    u32 status;
+    while (1) {
+        status = *MMCI_STATUS;
+        if (status & (MMCI_STAT_CMDRESPEND | MMCI_STAT_CMDSENT |
+                      MMCI_STAT_CMDTIMEOUT | MMCI_STAT_CMDCRCFAIL)) {
+            break;
+        }
+        if (timer_expired(deadline)) {
+            return -1;  // Timeout
+        }
+    }
+
+    if (status & MMCI_STAT_CMDTIMEOUT) {
+        return -1;  // Timeout
+    }
+
+    return 0;
+}
+
+// Program the bus clock to the fastest rate not above hz
+static void sd_set_clock(u32 hz) {
+    u32 reg;
+
+    if (hz >= SD_MCLK_HZ) {
+        reg = MMCI_CLK_ENABLE | MMCI_CLK_BYPASS;
+        sd_clock_hz = SD_MCLK_HZ;
+    } else {
+        u32 div = 0;
+        while (div < MMCI_CLK_DIV_MASK && (u64)hz * 2 * (div + 1) < SD_MCLK_HZ) {
+            div++;
+        }
+        reg = MMCI_CLK_ENABLE | div;
+        sd_clock_hz = SD_MCLK_HZ / (2 * (div + 1));
+    }
+
+    if (sd_bus_width == 4) {
+        reg |= MMCI_CLK_WIDEBUS;
+    }
+    *MMCI_CLOCK = reg;
+}
+
+// Check whether the controller implements the wide bus bit
+// Controllers without 4-bit support read the bit back as zero.
+static int sd_host_has_widebus(void) {
+    u32 saved = *MMCI_CLOCK;
+    *MMCI_CLOCK = saved | MMCI_CLK_WIDEBUS;
+    int supported = (*MMCI_CLOCK & MMCI_CLK_WIDEBUS) != 0;
+    *MMCI_CLOCK = saved;
+    return supported;
+}
+
+// Drain words from the data FIFO and wait for the end of the transfer
+// Returns 0 on success, -1 on data error or timeout
+static int sd_read_fifo(u32 *buf32, u32 words) {
+    u32 words_read = 0;
+    u32 deadline = timer_deadline_us(SD_DATA_TIMEOUT_US);
+
+    while (words_read < words && !timer_expired(deadline)) {
+        u32 status = *MMCI_STATUS;
+
+        if (status & (MMCI_STAT_DATACRCFAIL | MMCI_STAT_DATATIMEOUT | MMCI_STAT_RXOVERRUN)) {
+            return -1;  // Data error
+        }
+
+        if (status & MMCI_STAT_RXDATAAVAIL) {
+            buf32[words_read++] = *MMCI_FIFO;
+        }
+    }
+
+    if (words_read < words) {
+        return -1;  // Incomplete read
+    }
+
+    // Wait for data end
+    while (!(*MMCI_STATUS & MMCI_STAT_DATAEND)) {
+        if (timer_expired(deadline)) {
+            return -1;
+        }
+    }
+
+    // Clear status
+    *MMCI_CLEAR = 0x7FF;
+    return 0;
+}
+
+// Extract a bit field from the CSD (bit numbers as in the SD spec)
+static u32 sd_csd_bits(int start, int size) {
+    int word = 3 - (start >> 5);
+    int shift = start & 31;
+    u32 value = sd_csd[word] >> shift;
+    if (size + shift > 32) {
+        value |= sd_csd[word - 1] << (32 - shift);
+    }
+    return (size < 32) ? (value & ((1u << size) - 1)) : value;
+}
+
+// Decode card capacity from the CSD
+static void sd_parse_csd(void) {
+    u32 structure = sd_csd_bits(126, 2);
+
+    if (structure == 1) {
+        // CSD 2.0 (SDHC/SDXC): capacity = (C_SIZE + 1) * 512 KB
+        u32 c_size = sd_csd_bits(48, 22);
+        sd_capacity = (c_size + 1) << 10;
+    } else {
+        // CSD 1.0 (SDSC): capacity = (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN
+        u32 c_size = sd_csd_bits(62, 12);
+        u32 c_size_mult = sd_csd_bits(47, 3);
+        u32 read_bl_len = sd_csd_bits(80, 4);
+        sd_capacity = (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+    }
+
+    // TRAN_SPEED: rate unit (100 kbit/s * 10^n) times a time value / 10
+    static const u32 tran_exp[8] = {
+        10000, 100000, 1000000, 10000000, 0, 0, 0, 0
+    };
+    static const u8 tran_mant[16] = {
+        0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80
+    };
+    u32 tran_speed = sd_csd_bits(96, 8);
+    sd_max_hz = tran_exp[tran_speed & 7] * tran_mant[(tran_speed >> 3) & 0xF];
+    if (sd_max_hz == 0) {
+        sd_max_hz = SD_DEFAULT_CLOCK_HZ;
+    }
+}
+
+// Read the SD Configuration Register (ACMD51, 8-byte data block)
+static int sd_read_scr(void) {
+    u32 scr32[2];
+
+    *MMCI_CLEAR = 0x7FF;
+    *MMCI_DATATIMER = 0xFFFFFF;
+    *MMCI_DATALENGTH = sizeof(sd_scr);
+    *MMCI_DATACTRL = MMCI_DCTRL_ENABLE | MMCI_DCTRL_DIRECTION |
+                     MMCI_DCTRL_BLOCKSIZE(3);  // 2^3 = 8 bytes
+
+    if (sd_send_cmd(SD_CMD_APP_CMD, sd_rca << 16, 1) != 0 ||
+        sd_send_cmd(SD_ACMD_SEND_SCR, 0, 1) != 0) {
+        return -1;
+    }
+
+    if (sd_read_fifo(scr32, 2) != 0) {
+        return -1;
+    }
+
+    // The FIFO packs the big-endian register bytes in arrival order
+    for (int i = 0; i < 8; i++) {
+        sd_scr[i] = (u8)(scr32[i >> 2] >> ((i & 3) * 8));
+    }
+    return 0;
+}
+
+// Convert a sector number into the address format the card expects
+static inline u32 sd_block_addr(u32 lba) {
+    return sd_high_capacity ? lba : lba * SD_SECTOR_SIZE;
+}
+
+// Check that a transfer stays inside the card
+static inline int sd_range_ok(u32 lba, u32 count) {
+    return lba < sd_capacity && count <= sd_capacity - lba;
+}
+
+// Card bring-up state machine
+// Each step either issues commands that complete immediately or waits for
+// a deadline, so sd_init_poll() never spins and boot work can run between
+// calls while the card powers up and finishes its internal initialization.
+static int sd_init_step(void) {
+    switch (sd_state) {
+        case SD_INIT_OFF:
+        case SD_INIT_FAILED:
+            // Power on the controller
+            sd_initialized = 0;
+            sd_bus_width = 1;
+            *MMCI_POWER = MMCI_POWER_UP;
+            sd_deadline = timer_deadline_us(SD_POWER_RAMP_US);
+            sd_state = SD_INIT_POWER_UP;
+            return SD_INIT_PENDING;
+
+        case SD_INIT_POWER_UP:
+            if (!timer_expired(sd_deadline)) return SD_INIT_PENDING;
+            *MMCI_POWER = MMCI_POWER_ON;
+
+            // Set clock (slow for init) and give the card its 74+ clocks
+            sd_set_clock(SD_INIT_CLOCK_HZ);
+            sd_deadline = timer_deadline_us(SD_POWER_RAMP_US);
+            sd_state = SD_INIT_CLOCK_RAMP;
+            return SD_INIT_PENDING;
+
+        case SD_INIT_CLOCK_RAMP:
+            if (!timer_expired(sd_deadline)) return SD_INIT_PENDING;
+
+            // CMD0: Go idle
+            sd_send_cmd(SD_CMD_GO_IDLE, 0, 0);
+
+            // CMD8: Send interface condition (for SD 2.0+)
+            // Only cards that echo the check pattern may be offered HCS
+            sd_ocr_arg = SD_OCR_VOLTAGE;
+            if (sd_send_cmd(SD_CMD_SEND_IF_COND, 0x1AA, 1) == 0 &&
+                (*MMCI_RESPONSE0 & 0xFFF) == 0x1AA) {
+                sd_ocr_arg |= SD_OCR_HCS;
+            }
+
+            sd_op_cond_deadline = timer_deadline_us(SD_OP_COND_TIMEOUT_US);
+            sd_deadline = timer_ticks();
+            sd_state = SD_INIT_OP_COND;
+            return SD_INIT_PENDING;
+
+        case SD_INIT_OP_COND: {
+            if (!timer_expired(sd_deadline)) return SD_INIT_PENDING;
+
+            // ACMD41: Send operating condition (with HCS bit for SDHC)
+            sd_send_cmd(SD_CMD_APP_CMD, 0, 1);
+            sd_send_cmd(SD_ACMD_SD_SEND_OP_COND, sd_ocr_arg, 1);
+
+            u32 ocr = *MMCI_RESPONSE0;
+            if (!(ocr & SD_OCR_BUSY)) {
+                if (timer_expired(sd_op_cond_deadline)) {
+                    sd_state = SD_INIT_FAILED;
+                    return -1;  // Card init failed
+                }
+                // Card still running its power-up sequence; ask again later
+                sd_deadline = timer_deadline_us(SD_OP_COND_POLL_US);
+                return SD_INIT_PENDING;
+            }
+
+            // CCS is only valid once the busy bit is set
+            sd_high_capacity = (ocr & SD_OCR_CCS) ? 1 : 0;
+            sd_state = SD_INIT_IDENTIFY;
+            return SD_INIT_PENDING;
+        }
+
+        case SD_INIT_IDENTIFY:
+            // CMD2: Get CID
+            sd_send_cmd(SD_CMD_ALL_SEND_CID, 0, SD_RESP_LONG);
+
+            // CMD3: Get RCA
+            if (sd_send_cmd(SD_CMD_SEND_REL_ADDR, 0, 1) != 0) {
+                sd_state = SD_INIT_FAILED;
+                return -1;
+            }
+            sd_rca = (*MMCI_RESPONSE0 >> 16) & 0xFFFF;
+
+            // CMD9: Get CSD (card must still be in stand-by state)
+            if (sd_send_cmd(SD_CMD_SEND_CSD, sd_rca << 16, SD_RESP_LONG) != 0) {
+                sd_state = SD_INIT_FAILED;
+                return -1;
+            }
+            sd_csd[0] = *MMCI_RESPONSE0;
+            sd_csd[1] = *MMCI_RESPONSE1;
+            sd_csd[2] = *MMCI_RESPONSE2;
+            sd_csd[3] = *MMCI_RESPONSE3;
+            sd_parse_csd();
+
+            // CMD7: Select card
+            if (sd_send_cmd(SD_CMD_SELECT_CARD, sd_rca << 16, 1) != 0) {
+                sd_state = SD_INIT_FAILED;
+                return -1;
+            }
+
+            // CMD16: Set block length to 512
+            sd_send_cmd(SD_CMD_SET_BLOCKLEN, SD_SECTOR_SIZE, 1);
+
+            // ACMD6: Switch to a 4-bit bus if both card and controller support it
+            if (sd_read_scr() == 0 && (sd_scr[1] & SD_SCR_BUS_WIDTH_4) &&
+                sd_host_has_widebus()) {
+                if (sd_send_cmd(SD_CMD_APP_CMD, sd_rca << 16, 1) == 0 &&
+                    sd_send_cmd(SD_ACMD_SET_BUS_WIDTH, 2, 1) == 0) {
+                    sd_bus_width = 4;
+                }
+            }
+
+            // Run the bus at the card's rated speed now that it is initialized
+            sd_set_clock(sd_max_hz);
+
+            sd_state = SD_INIT_READY;
+            sd_initialized = 1;
+            klog("sd: %s, %u sectors, %d-bit bus at %u Hz",
+                 sd_high_capacity ? "SDHC/SDXC" : "SDSC", sd_capacity,
+                 sd_bus_width, sd_clock_hz);
+            return 0;
+
+        case SD_INIT_READY:
+            return 0;
+    }
+
+    return -1;
+}
+
+// Advance card bring-up as far as possible without waiting
+// Returns SD_INIT_PENDING while in progress, 0 when ready, -1 on failure
+int sd_init_poll(void) {
+    int result;
+    sd_init_state_t before;
+
+    do {
+        before = sd_state;
+        result = sd_init_step();
+    } while (result == SD_INIT_PENDING && sd_state != before);
+
+    return result;
+}
+
+// Begin card bring-up without waiting for it to finish
+void sd_init_start(void) {
+    if (sd_state == SD_INIT_OFF || sd_state == SD_INIT_FAILED) {
+        sd_init_poll();
+    }
+}
+
+// Initialize SD card (blocks until the card is ready or init fails)
+int sd_init(void) {
+    if (sd_initialized) return 0;
+
+    if (sd_state == SD_INIT_FAILED) {
+        sd_state = SD_INIT_OFF;  // Retry from power-up
+    }
+
+    int result;
+    while ((result = sd_init_poll()) == SD_INIT_PENDING) {
+        co_yield();
+    }
+    if (result != 0) {
+        klog("sd: card initialization failed");
+    }
+    return result;
+}
+
+// Wait until the card has left the programming state
+// Writes and erases keep the card busy after the command/data phase ends.
+// The PL181 has no busy detection, so ask the card with CMD13 instead.
+// Other coroutines run between polls; the FIFO is idle at this point.
+// Returns 0 once the card is back in the transfer state, -1 on timeout
+static int sd_wait_ready(u32 timeout_us) {
+    u32 deadline = timer_deadline_us(timeout_us);
+    while (!timer_expired(deadline)) {
+        if (sd_send_cmd(SD_CMD_SEND_STATUS, sd_rca << 16, 1) == 0) {
+            u32 status = *MMCI_RESPONSE0;
+            if ((status & SD_R1_READY_FOR_DATA) &&
+                SD_R1_STATE(status) == SD_STATE_TRAN) {
+                return 0;
+            }
+        }
+        co_yield();
+    }
+    return -1;
+}
+
+// ============================================================================
+// Transfer Ownership
+// ============================================================================
+
+// A transfer yields between sectors and while the card is busy, so another
+// coroutine or thread could otherwise start a command in the middle of it.
+// The busy flag hands the controller to one transfer at a time.
+
+static int sd_idle(void *arg) {
+    (void)arg;
+    return !sd_busy;
+}
+
+static void sd_claim(void) {
+    while (1) {
+        u32 flags = irq_save();
+        if (!sd_busy) {
+            sd_busy = 1;
+            irq_restore(flags);
+            return;
+        }
+        irq_restore(flags);
+        co_await_io(sd_idle, 0);
+    }
+}
+
+static void sd_release(void) {
+    sd_busy = 0;
+}
+
+// Check if SD is initialized
+int sd_is_initialized(void) {
+    return sd_initialized;
+}
+
+// Card size in 512-byte sectors (0 until the card is initialized)
+u32 sd_get_capacity(void) {
+    return sd_capacity;
+}
+
+// Check if the card is SDHC/SDXC (block addressed)
+int sd_is_high_capacity(void) {
+    return sd_high_capacity;
+}
+
+// Negotiated data bus width in bits (1 or 4)
+int sd_get_bus_width(void) {
+    return sd_bus_width;
+}
+
+// Negotiated bus clock in Hz
+u32 sd_get_clock_hz(void) {
+    return sd_clock_hz;
+}
+
+// Card's rated maximum clock in Hz (from CSD TRAN_SPEED)
+u32 sd_get_max_clock_hz(void) {
+    return sd_max_hz;
+}
+
+// Sectors transferred since boot
+static u32 sd_sectors_read = 0;
+static u32 sd_sectors_written = 0;
+
+void sd_get_stats(u32 *sectors_read, u32 *sectors_written) {
+    *sectors_read = sd_sectors_read;
+    *sectors_written = sd_sectors_written;
+}
+
+// Read sectors with the controller claimed
+static int sd_read_claimed(u32 lba, u32 count, u8 *buf) {
+    for (u32 sector = 0; sector < count; sector++) {
+        // Safe point: the previous block is fully drained
+        if (sector > 0) co_yield();
+
+        u32 addr = sd_block_addr(lba + sector);
+
+        // Clear status
+        *MMCI_CLEAR = 0x7FF;
+
+        // Set up data transfer
+        *MMCI_DATATIMER = 0xFFFFFF;
+        *MMCI_DATALENGTH = SD_SECTOR_SIZE;
+        *MMCI_DATACTRL = MMCI_DCTRL_ENABLE | MMCI_DCTRL_DIRECTION |
+                         MMCI_DCTRL_BLOCKSIZE(9);  // 2^9 = 512 bytes
+
+        // CMD17: Read single block
+        if (sd_send_cmd(SD_CMD_READ_SINGLE, addr, 1) != 0) {
+            return -1;
+        }
+
+        // Read data from FIFO
+        u32 *buf32 = (u32 *)(buf + sector * SD_SECTOR_SIZE);
+        if (sd_read_fifo(buf32, SD_SECTOR_SIZE / 4) != 0) {
+            return -1;
+        }
+        sd_sectors_read++;
+    }
+
+    return 0;
+}
+
+// Read sectors from SD card
+// lba: Logical Block Address (sector number)
+// count: Number of sectors to read
+// buffer: Output buffer (must be at least count * 512 bytes)
+// Returns 0 on success, -1 on error
+int sd_read_sectors(u32 lba, u32 count, void *buffer) {
+    if (!sd_initialized) {
+        if (sd_init() != 0) {
+            return -1;
+        }
+    }
+
+    if (!sd_range_ok(lba, count)) {
+        return -1;  // Past end of card
+    }
+
+    sd_claim();
+    int result = sd_read_claimed(lba, count, (u8 *)buffer);
+    sd_release();
+    return result;
+}
+
+// Write sectors with the controller claimed
+// Yields only while the card programs a block (sd_wait_ready), never while
+// the FIFO is being filled.
+static int sd_write_claimed(u32 lba, u32 count, const u8 *buf) {
+    for (u32 sector = 0; sector < count; sector++) {
+        u32 addr = sd_block_addr(lba + sector);
+
+        // Clear status
+        *MMCI_CLEAR = 0x7FF;
+
+        // Set up data transfer (write direction: card receives)
+        *MMCI_DATATIMER = 0xFFFFFF;
+        *MMCI_DATALENGTH = SD_SECTOR_SIZE;
+        // Direction bit = 0 for write (controller to card)
+        *MMCI_DATACTRL = MMCI_DCTRL_ENABLE | MMCI_DCTRL_BLOCKSIZE(9);
+
+        // CMD24: Write single block
+        if (sd_send_cmd(SD_CMD_WRITE_SINGLE, addr, 1) != 0) {
+            return -1;
+        }
+
+        // Write data to FIFO
+        const u32 *buf32 = (const u32 *)(buf + sector * SD_SECTOR_SIZE);
+        int words_written = 0;
+        u32 deadline = timer_deadline_us(SD_DATA_TIMEOUT_US);
+
+        while (words_written < (SD_SECTOR_SIZE / 4) && !timer_expired(deadline)) {
+            u32 status = *MMCI_STATUS;
+
+            if (status & (MMCI_STAT_DATACRCFAIL | MMCI_STAT_DATATIMEOUT | MMCI_STAT_TXUNDERRUN)) {
+                return -1;  // Data error
+            }
+
+            // Check if FIFO has space (not full)
+            if (!(status & MMCI_STAT_TXFIFOFULL)) {
+                *MMCI_FIFO = buf32[words_written++];
+            }
+        }
+
+        if (words_written < (SD_SECTOR_SIZE / 4)) {
+            return -1;  // Incomplete write
+        }
+
+        // Wait for data end
+        while (!(*MMCI_STATUS & MMCI_STAT_DATAEND)) {
+            if (timer_expired(deadline)) {
+                return -1;
+            }
+        }
+
+        // Clear status
+        *MMCI_CLEAR = 0x7FF;
+
+        // Wait for the card to finish programming the block
+        if (sd_wait_ready(SD_WRITE_TIMEOUT_US) != 0) {
+            return -1;
+        }
+        sd_sectors_written++;
+    }
+
+    return 0;
+}
+
+// Write sectors to SD card
+// lba: Logical Block Address (sector number)
+// count: Number of sectors to write
+// buffer: Input buffer (must be at least count * 512 bytes)
+// Returns 0 on success, -1 on error
+int sd_write_sectors(u32 lba, u32 count, const void *buffer) {
+    if (!sd_initialized) {
+        if (sd_init() != 0) {
+            return -1;
+        }
+    }
+
+    if (!sd_range_ok(lba, count)) {
+        return -1;  // Past end of card
+    }
+
+    sd_claim();
+    int result = sd_write_claimed(lba, count, (const u8 *)buffer);
+    sd_release();
+    return result;
+}
+
+// Erase (discard) a range of sectors
+// Tells the card the blocks no longer hold data so its controller can
+// pre-erase them instead of doing read-modify-write on the next write.
+// lba: First sector to erase
+// count: Number of sectors to erase
+// Returns 0 on success, -1 on error
+int sd_erase_sectors(u32 lba, u32 count) {
+    if (count == 0) return 0;
+
+    if (!sd_initialized) {
+        if (sd_init() != 0) {
+            return -1;
+        }
+    }
+
+    if (!sd_range_ok(lba, count)) {
+        return -1;  // Past end of card
+    }
+
+    u32 start = sd_block_addr(lba);
+    u32 end = sd_block_addr(lba + count - 1);
+    int result = -1;
+
+    sd_claim();
+
+    // CMD32/CMD33: Set first and last block of the erase group
+    // CMD38: Erase (R1b - card stays busy until the erase is done)
+    if (sd_send_cmd(SD_CMD_ERASE_WR_BLK_START, start, 1) == 0 &&
+        sd_send_cmd(SD_CMD_ERASE_WR_BLK_END, end, 1) == 0 &&
+        sd_send_cmd(SD_CMD_ERASE, 0, 1) == 0) {
+        result = sd_wait_ready(SD_ERASE_TIMEOUT_US);
+    }
+
+    sd_release();
+    return result;
+}
@@ -4,8 +4,8 @@
 /*
  * PL181 SD/MMC Controller Driver for VersatilePB
  *
- * This driver provides block-level read access to SD cards
- * attached via QEMU's -drive file=disk.img,if=sd option.
+ * This driver provides block-level read, write and erase access to
+ * SD cards attached via QEMU's -drive file=disk.img,if=sd option.
  */
 
 #include <package.h>
@@ -64,6 +64,18 @@
 #define MMCI_CMD_PENDING        (1 << 9)
 #define MMCI_CMD_ENABLE         (1 << 10)
 
+// Clock register bits
+#define MMCI_CLK_DIV_MASK       0xFF        // MCICLK = MCLK / (2 * (div + 1))
+#define MMCI_CLK_ENABLE         (1 << 8)
+#define MMCI_CLK_PWRSAVE        (1 << 9)
+#define MMCI_CLK_BYPASS         (1 << 10)   // MCICLK = MCLK
+#define MMCI_CLK_WIDEBUS        (1 << 11)   // 4-bit data bus
+
+// MMCI reference clock on VersatilePB
+#define SD_MCLK_HZ              24000000
+#define SD_INIT_CLOCK_HZ        400000      // Identification mode limit
+#define SD_DEFAULT_CLOCK_HZ     25000000    // Default speed if CSD is unreadable
+
 // Data control bits
 #define MMCI_DCTRL_ENABLE       (1 << 0)
 #define MMCI_DCTRL_DIRECTION    (1 << 1)  // 1 = read (card to controller)
@@ -85,195 +97,64 @@
 #define SD_CMD_SEND_IF_COND     8
 #define SD_CMD_SEND_CSD         9
 #define SD_CMD_STOP_TRANSMISSION 12
+#define SD_CMD_SEND_STATUS      13
 #define SD_CMD_SET_BLOCKLEN     16
 #define SD_CMD_READ_SINGLE      17
 #define SD_CMD_READ_MULTIPLE    18
+#define SD_CMD_WRITE_SINGLE     24
+#define SD_CMD_WRITE_MULTIPLE   25
+#define SD_CMD_ERASE_WR_BLK_START 32
+#define SD_CMD_ERASE_WR_BLK_END 33
+#define SD_CMD_ERASE            38
 #define SD_CMD_APP_CMD          55
+#define SD_ACMD_SET_BUS_WIDTH   6
 #define SD_ACMD_SD_SEND_OP_COND 41
+#define SD_ACMD_SEND_SCR        51
 
-// Sector size
-#define SD_SECTOR_SIZE          512
-
-// Global state
-static int sd_initialized = 0;
-static u32 sd_rca = 0;  // Relative Card Address
-
-// Delay loop
-static void sd_delay(int count) {
-    for (volatile int i = 0; i < count; i++) {
-        __asm__ volatile("nop");
-    }
-}
-
-// Send command and wait for response
-static int sd_send_cmd(u32 cmd, u32 arg, int response) {
-    // Clear status flags
-    *MMCI_CLEAR = 0x7FF;
-
-    // Set argument
-    *MMCI_ARGUMENT = arg;
-
-    // Build command register value
-    u32 cmd_reg = (cmd & 0x3F) | MMCI_CMD_ENABLE;
-    if (response) {
-        cmd_reg |= MMCI_CMD_RESPONSE;
-    }
-
-    // Send command
-    *MMCI_COMMAND = cmd_reg;
-
-    // Wait for command to complete
-    u32 status;
-    int timeout = 100000;
-    while (timeout-- > 0) {
-        status = *MMCI_STATUS;
-        if (status & (MMCI_STAT_CMDRESPEND | MMCI_STAT_CMDSENT |
-                      MMCI_STAT_CMDTIMEOUT | MMCI_STAT_CMDCRCFAIL)) {
-            break;
-        }
-    }
-
-    if (timeout <= 0 || (status & MMCI_STAT_CMDTIMEOUT)) {
-        return -1;  // Timeout
-    }
-
-    return 0;
-}
-
-// Initialize SD card
-static int sd_init(void) {
-    if (sd_initialized) return 0;
-
-    // Power on the controller
-    *MMCI_POWER = MMCI_POWER_UP;
-    sd_delay(10000);
-    *MMCI_POWER = MMCI_POWER_ON;
-    sd_delay(10000);
-
-    // Set clock (slow for init)
-    *MMCI_CLOCK = 0x1FF;  // Enable clock, slow divider
-    sd_delay(10000);
-
-    // CMD0: Go idle
-    sd_send_cmd(SD_CMD_GO_IDLE, 0, 0);
-    sd_delay(10000);
-
-    // CMD8: Send interface condition (for SD 2.0+)
-    sd_send_cmd(SD_CMD_SEND_IF_COND, 0x1AA, 1);
-    sd_delay(1000);
-
-    // ACMD41: Send operating condition (with HCS bit for SDHC)
-    int retries = 100;
-    while (retries-- > 0) {
-        sd_send_cmd(SD_CMD_APP_CMD, 0, 1);
-        sd_send_cmd(SD_ACMD_SD_SEND_OP_COND, 0x40300000, 1);
-
-        u32 resp = *MMCI_RESPONSE0;
-        if (resp & 0x80000000) {
-            // Card is ready
-            break;
-        }
-        sd_delay(10000);
-    }
+// SCR fields (byte 1 holds SD_BUS_WIDTHS in its low nibble)
+#define SD_SCR_BUS_WIDTH_4      (1 << 2)
 
-    if (retries <= 0) {
-        return -1;  // Card init failed
-    }
+// R1 card status bits (response to CMD13 and most addressed commands)
+#define SD_R1_READY_FOR_DATA    (1 << 8)
+#define SD_R1_STATE(r)          (((r) >> 9) & 0xF)
+#define SD_STATE_TRAN           4
 
-    // CMD2: Get CID
-    sd_send_cmd(SD_CMD_ALL_SEND_CID, 0, 1);
-    sd_delay(1000);
+// OCR bits (ACMD41 argument/response)
+#define SD_OCR_BUSY             (1u << 31)  // 1 = power-up complete
+#define SD_OCR_CCS              (1u << 30)  // Card Capacity Status (SDHC/SDXC)
+#define SD_OCR_HCS              (1u << 30)  // Host Capacity Support
+#define SD_OCR_VOLTAGE          0x00300000  // 3.2-3.4V window
 
-    // CMD3: Get RCA
-    sd_send_cmd(SD_CMD_SEND_REL_ADDR, 0, 1);
-    sd_rca = (*MMCI_RESPONSE0 >> 16) & 0xFFFF;
-    sd_delay(1000);
+// Response types for sd_send_cmd
+#define SD_RESP_NONE            0
+#define SD_RESP_SHORT           1
+#define SD_RESP_LONG            2           // 136-bit R2 (CID/CSD)
 
-    // CMD7: Select card
-    sd_send_cmd(SD_CMD_SELECT_CARD, sd_rca << 16, 1);
-    sd_delay(1000);
-
-    // CMD16: Set block length to 512
-    sd_send_cmd(SD_CMD_SET_BLOCKLEN, SD_SECTOR_SIZE, 1);
-    sd_delay(1000);
-
-    // Speed up clock now that card is initialized
-    *MMCI_CLOCK = 0x100;  // Faster clock
-
-    sd_initialized = 1;
-    return 0;
-}
-
-// Check if SD is initialized
-static int sd_is_initialized(void) {
-    return sd_initialized;
-}
-
-// Read sectors from SD card
-// lba: Logical Block Address (sector number)
-// count: Number of sectors to read
-// buffer: Output buffer (must be at least count * 512 bytes)
-// Returns 0 on success, -1 on error
-static int sd_read_sectors(u32 lba, u32 count, void *buffer) {
-    if (!sd_initialized) {
-        if (sd_init() != 0) {
-            return -1;
-        }
-    }
-
-    u8 *buf = (u8 *)buffer;
-
-    for (u32 sector = 0; sector < count; sector++) {
-        u32 addr = (lba + sector) * SD_SECTOR_SIZE;  // Byte address for standard SD
-
-        // Clear status
-        *MMCI_CLEAR = 0x7FF;
-
-        // Set up data transfer
-        *MMCI_DATATIMER = 0xFFFFFF;
-        *MMCI_DATALENGTH = SD_SECTOR_SIZE;
-        *MMCI_DATACTRL = MMCI_DCTRL_ENABLE | MMCI_DCTRL_DIRECTION |
-                         MMCI_DCTRL_BLOCKSIZE(9);  // 2^9 = 512 bytes
-
-        // CMD17: Read single block
-        if (sd_send_cmd(SD_CMD_READ_SINGLE, addr, 1) != 0) {
-            return -1;
-        }
-
-        // Read data from FIFO
-        u32 *buf32 = (u32 *)(buf + sector * SD_SECTOR_SIZE);
-        int words_read = 0;
-        int timeout = 1000000;
-
-        while (words_read < (SD_SECTOR_SIZE / 4) && timeout-- > 0) {
-            u32 status = *MMCI_STATUS;
-
-            if (status & (MMCI_STAT_DATACRCFAIL | MMCI_STAT_DATATIMEOUT | MMCI_STAT_RXOVERRUN)) {
-                return -1;  // Data error
-            }
-
-            if (status & MMCI_STAT_RXDATAAVAIL) {
-                buf32[words_read++] = *MMCI_FIFO;
-            }
-        }
-
-        if (words_read < (SD_SECTOR_SIZE / 4)) {
-            return -1;  // Incomplete read
-        }
-
-        // Wait for data end
-        timeout = 100000;
-        while (timeout-- > 0) {
-            if (*MMCI_STATUS & MMCI_STAT_DATAEND) {
-                break;
-            }
-        }
-
-        // Clear status
-        *MMCI_CLEAR = 0x7FF;
-    }
+// Sector size
+#define SD_SECTOR_SIZE          512
 
-    return 0;
-}
+// sd_init_poll() result while bring-up is still in progress
+#define SD_INIT_PENDING         1
+
+// Card bring-up
+void sd_init_start(void);
+int sd_init_poll(void);
+int sd_init(void);
+
+// Card information
+int sd_is_initialized(void);
+u32 sd_get_capacity(void);
+int sd_is_high_capacity(void);
+int sd_get_bus_width(void);
+u32 sd_get_clock_hz(void);
+u32 sd_get_max_clock_hz(void);
+
+// Block access (lba and count in 512-byte sectors)
+int sd_read_sectors(u32 lba, u32 count, void *buffer);
+int sd_write_sectors(u32 lba, u32 count, const void *buffer);
+int sd_erase_sectors(u32 lba, u32 count);
+
+// Sectors transferred since boot
+void sd_get_stats(u32 *sectors_read, u32 *sectors_written);
 
 #endif
@@ -0,0 +1,173 @@
+#include "ps2Keyboard.h"
+#include <io/input.h>
+#include <sys/irq.h>
+
+#if CONFIG_PS2
+
+// PS/2 Scancode Set 2 to ASCII - Norwegian layout
+// The PL050 in QEMU uses Scancode Set 2
+static const char scancode_set2[256] = {
+    // 0x00 - 0x0F
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    '\t', '|',  0,
+    // 0x10 - 0x1F
+    0,    0,    0,    0,    0,    'q',  '1',  0,    0,    0,    'z',  's',  'a',  'w',  '2',  0,
+    // 0x20 - 0x2F
+    0,    'c',  'x',  'd',  'e',  '4',  '3',  0,    0,    ' ',  'v',  'f',  't',  'r',  '5',  0,
+    // 0x30 - 0x3F
+    0,    'n',  'b',  'h',  'g',  'y',  '6',  0,    0,    0,    'm',  'j',  'u',  '7',  '8',  0,
+    // 0x40 - 0x4F
+    0,    ',',  'k',  'i',  'o',  '0',  '9',  0,    0,    '.',  '-',  'l',  ';',  'p',  '+',  0,
+    // 0x50 - 0x5F
+    0,    0,    '\'', 0,    '[',  '\\', 0,    0,    0,    0,    '\n', ']',  0,    '\'', 0,    0,
+    // 0x60 - 0x6F
+    0,    '<',  0,    0,    0,    0,    '\b', 0,    0,    '1',  0,    '4',  '7',  0,    0,    0,
+    // 0x70 - 0x7F
+    '0',  '.',  '2',  '5',  '6',  '8',  27,   0,    0,    '+',  '3',  '-',  '*',  '9',  0,    0,
+    // 0x80 - 0xFF (unused, fill with 0)
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+
+// PS/2 Scancode Set 2 to ASCII - Norwegian layout (SHIFTED)
+static const char scancode_set2_shift[256] = {
+    // 0x00 - 0x0F
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    '\t', '~',  0,
+    // 0x10 - 0x1F
+    0,    0,    0,    0,    0,    'Q',  '!',  0,    0,    0,    'Z',  'S',  'A',  'W',  '"',  0,
+    // 0x20 - 0x2F
+    0,    'C',  'X',  'D',  'E',  '$',  '#',  0,    0,    ' ',  'V',  'F',  'T',  'R',  '%',  0,
+    // 0x30 - 0x3F
+    0,    'N',  'B',  'H',  'G',  'Y',  '&',  0,    0,    0,    'M',  'J',  'U',  '/',  '(',  0,
+    // 0x40 - 0x4F
+    0,    ';',  'K',  'I',  'O',  '=',  ')',  0,    0,    ':',  '_',  'L',  ':',  'P',  '?',  0,
+    // 0x50 - 0x5F
+    0,    0,    '*',  0,    '{',  '`',  0,    0,    0,    0,    '\n', '}',  0,    '*',  0,    0,
+    // 0x60 - 0x6F
+    0,    '>',  0,    0,    0,    0,    '\b', 0,    0,    '1',  0,    '4',  '7',  0,    0,    0,
+    // 0x70 - 0x7F
+    '0',  '.',  '2',  '5',  '6',  '8',  27,   0,    0,    '+',  '3',  '-',  '*',  '9',  0,    0,
+    // 0x80 - 0xFF (unused, fill with 0)
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+
+// Decoder state, only touched by ps2_decode()
+static int shift_pressed = 0;
+static int ctrl_pressed = 0;
+static int release_next = 0;
+static int extended_next = 0;
+
+// ============================================================================
+// Scancode Decoding
+// ============================================================================
+
+// Keys that only exist with the E0 prefix
+static u16 ps2_extended_key(u8 scancode) {
+    switch (scancode) {
+        case 0x6C: return KEY_HOME;
+        case 0x69: return KEY_END;
+        case 0x71: return KEY_DELETE;
+        case 0x7D: return KEY_PGUP;
+        case 0x7A: return KEY_PGDN;
+        case 0x5A: return '\n';     // Keypad enter
+        case 0x4A: return '/';      // Keypad slash
+    }
+    return 0;
+}
+
+// Feed one byte from the keyboard; complete key presses go to the input queue
+static void ps2_decode(u8 scancode) {
+    // 0xE0 = extended key prefix, 0xF0 = key release prefix
+    if (scancode == 0xE0) {
+        extended_next = 1;
+        return;
+    }
+    if (scancode == 0xF0) {
+        release_next = 1;
+        return;
+    }
+
+    int release = release_next;
+    int extended = extended_next;
+    release_next = 0;
+    extended_next = 0;
+
+    // Modifiers (Left/Right Shift = 0x12/0x59, Ctrl = 0x14 with or without E0)
+    if (scancode == 0x12 || scancode == 0x59) {
+        shift_pressed = !release;
+        return;
+    }
+    if (scancode == 0x14) {
+        ctrl_pressed = !release;
+        return;
+    }
+
+    if (release) return;
+
+    // Arrows are decoded with or without E0: QEMU sometimes drops the prefix,
+    // so the keypad 8/2/4/6 keys act as arrows too.
+    u16 key = 0;
+    switch (scancode) {
+        case 0x75: key = KEY_UP;    break;
+        case 0x72: key = KEY_DOWN;  break;
+        case 0x6B: key = KEY_LEFT;  break;
+        case 0x74: key = KEY_RIGHT; break;
+    }
+
+    if (!key && extended) {
+        key = ps2_extended_key(scancode);
+        if (!key) return;  // Unknown extended key
+    }
+
+    if (!key) {
+        char c = shift_pressed ?
+            scancode_set2_shift[scancode] :
+            scancode_set2[scancode];
+        if (c == 0) return;
+
+        // Ctrl+letter gives the control character (Ctrl+C = 3)
+        if (ctrl_pressed && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+            c &= 0x1F;
+        }
+        key = (u8)c;
+    }
+
+    u8 mods = (shift_pressed ? KEY_MOD_SHIFT : 0) | (ctrl_pressed ? KEY_MOD_CTRL : 0);
+    input_push(key, mods);
+}
+
+// ============================================================================
+// Controller
+// ============================================================================
+
+// Decode every byte waiting in the KMI receive register
+static void ps2_drain(void) {
+    while (*KMI_STAT & KMI_STAT_RXFULL) {
+        ps2_decode((u8)(*KMI_DATA & 0xFF));
+    }
+}
+
+static void ps2_irq(void) {
+    ps2_drain();
+}
+
+// Initialize PS/2 keyboard with the receive interrupt enabled
+void ps2_init(void) {
+    *KMI_CLKDIV = 8;                        // Set clock divisor
+    *KMI_CR = KMI_CR_EN | KMI_CR_RXINTEN;   // Enable KMI, enable RX interrupt
+
+    irq_register_sic(SIC_KMI0, ps2_irq);
+}
+
+// Pick up bytes by hand (before the interrupt is on, or with IRQs masked)
+void ps2_poll(void) {
+    u32 flags = irq_save();
+    ps2_drain();
+    irq_restore(flags);
+}
+
+#endif // CONFIG_PS2
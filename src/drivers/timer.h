@@ -0,0 +1,39 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+/*
+ * Free-running time base for VersatilePB
+ *
+ * The system controller exposes a 24 MHz counter that runs from reset,
+ * so drivers can bound waits in real time without programming a timer.
+ */
+
+#include <package.h>
+
+#define SYS_BASE            0x10000000
+#define SYS_24MHZ           ((volatile u32 *)(SYS_BASE + 0x5C))
+
+#define TIMER_TICKS_PER_US  24
+
+// Current counter value (wraps every ~179 seconds)
+static inline u32 timer_ticks(void) {
+    return *SYS_24MHZ;
+}
+
+// Deadline us microseconds from now (us must stay below ~89 seconds)
+static inline u32 timer_deadline_us(u32 us) {
+    return timer_ticks() + us * TIMER_TICKS_PER_US;
+}
+
+// Check if a deadline has passed (wrap-safe)
+static inline int timer_expired(u32 deadline) {
+    return (i32)(timer_ticks() - deadline) >= 0;
+}
+
+// Busy-wait for us microseconds
+static inline void timer_delay_us(u32 us) {
+    u32 deadline = timer_deadline_us(us);
+    while (!timer_expired(deadline));
+}
+
+#endif
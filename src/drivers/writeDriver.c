@@ -0,0 +1,614 @@
+/*
+ * FAT32 Write Driver for Spark Kernel
+ */
+
+#include "writeDriver.h"
+
+// ============================================================================
+// Discard Support
+// ============================================================================
+
+// Enable or disable discarding of freed clusters (mount option)
+void fat32_set_discard(int enable) {
+    g_fat32_fs.discard = enable ? 1 : 0;
+}
+
+// Erase every queued range on the card and empty the queue
+// Returns 0 on success, -1 if any erase failed
+static int fat32_discard_flush_claimed(void) {
+    int result = 0;
+
+    for (u32 i = 0; i < g_fat32_discard.num_ranges; i++) {
+        fat32_extent_t *r = &g_fat32_discard.ranges[i];
+        u32 lba = fat32_cluster_to_lba(r->start_cluster);
+        u32 sectors = r->count * g_fat32_fs.sectors_per_cluster;
+
+        fat32_cache_invalidate(lba, sectors);
+        if (sd_erase_sectors(lba, sectors) != 0) {
+            result = -1;
+            continue;
+        }
+        g_fat32_discard.clusters_discarded += r->count;
+    }
+
+    g_fat32_discard.num_ranges = 0;
+    return result;
+}
+
+int fat32_discard_flush(void) {
+    fat32_claim();
+    int result = fat32_discard_flush_claimed();
+    fat32_release();
+    return result;
+}
+
+// Queue a freed cluster for discard
+// Clusters adjacent to a queued range extend it, so a freed chain turns
+// into a handful of large erases instead of one command per cluster.
+static void fat32_discard_cluster(u32 cluster) {
+    for (u32 i = 0; i < g_fat32_discard.num_ranges; i++) {
+        fat32_extent_t *r = &g_fat32_discard.ranges[i];
+        if (cluster == r->start_cluster + r->count) {
+            r->count++;
+            return;
+        }
+        if (cluster + 1 == r->start_cluster) {
+            r->start_cluster = cluster;
+            r->count++;
+            return;
+        }
+    }
+
+    // Queue full - push what we have to the card first
+    if (g_fat32_discard.num_ranges >= FAT32_DISCARD_MAX_RANGES) {
+        fat32_discard_flush();
+    }
+
+    fat32_extent_t *r = &g_fat32_discard.ranges[g_fat32_discard.num_ranges++];
+    r->start_cluster = cluster;
+    r->count = 1;
+}
+
+// Discard every free cluster on the mounted filesystem (offline fstrim)
+// Walks the FAT one sector at a time rather than one entry at a time.
+// Returns the number of clusters discarded, or -1 on error
+static int fat32_trim_free_claimed(void) {
+    if (!g_fat32_fs.initialized) {
+        return -1;
+    }
+
+    u8 fat_buffer[FAT32_SECTOR_SIZE];
+    u32 entries_per_sector = FAT32_SECTOR_SIZE / sizeof(u32);
+    u32 last_cluster = g_fat32_fs.total_clusters + 2;
+    u32 before = g_fat32_discard.clusters_discarded;
+    u32 cluster = 0;
+
+    for (u32 s = 0; s < g_fat32_fs.fat_size_sectors && cluster < last_cluster; s++) {
+        if (fat32_disk_read_sectors(g_fat32_fs.fat_start_lba + s, 1, fat_buffer) != 0) {
+            g_fat32_discard.num_ranges = 0;
+            return -1;
+        }
+
+        u32 *entries = (u32 *)fat_buffer;
+        for (u32 e = 0; e < entries_per_sector && cluster < last_cluster; e++, cluster++) {
+            if (cluster >= 2 && (entries[e] & 0x0FFFFFFF) == FAT32_FREE_CLUSTER) {
+                fat32_discard_cluster(cluster);
+            }
+        }
+    }
+
+    if (fat32_discard_flush() != 0) {
+        return -1;
+    }
+
+    return (int)(g_fat32_discard.clusters_discarded - before);
+}
+
+int fat32_trim_free(void) {
+    fat32_claim();
+    int result = fat32_trim_free_claimed();
+    fat32_release();
+    return result;
+}
+
+// ============================================================================
+// FAT32 Write Operations
+// ============================================================================
+
+// Allocate a new cluster and mark it as end-of-chain
+// Returns the allocated cluster number, or 0 on failure
+static u32 fat32_alloc_cluster_claimed(void) {
+    u32 cluster = fat32_find_free_cluster();
+    if (cluster == 0) {
+        return 0;  // No free clusters
+    }
+
+    // Mark cluster as end-of-chain
+    if (fat32_write_fat_entry(cluster, FAT32_EOC) != 0) {
+        return 0;
+    }
+
+    return cluster;
+}
+
+u32 fat32_alloc_cluster(void) {
+    fat32_claim();
+    u32 result = fat32_alloc_cluster_claimed();
+    fat32_release();
+    return result;
+}
+
+// Free a cluster chain starting from the given cluster
+// With the discard mount option the freed clusters are erased before
+// returning, so a following allocation never reuses a cluster that still
+// has an erase pending against it.
+static int fat32_free_chain_claimed(u32 start_cluster) {
+    u32 cluster = start_cluster;
+
+    while (cluster >= 2 && !fat32_is_eoc(cluster)) {
+        u32 next = fat32_next_cluster(cluster);
+        if (fat32_write_fat_entry(cluster, FAT32_FREE_CLUSTER) != 0) {
+            if (g_fat32_fs.discard) fat32_discard_flush();
+            return -1;
+        }
+        if (g_fat32_fs.discard) {
+            fat32_discard_cluster(cluster);
+        }
+        cluster = next;
+    }
+
+    if (g_fat32_fs.discard) {
+        fat32_discard_flush();
+    }
+
+    return 0;
+}
+
+int fat32_free_chain(u32 start_cluster) {
+    fat32_claim();
+    int result = fat32_free_chain_claimed(start_cluster);
+    fat32_release();
+    return result;
+}
+
+// Write a cluster to disk
+static int fat32_write_cluster_data(u32 cluster, const void *buffer) {
+    if (!g_fat32_fs.initialized) return -1;
+    if (cluster < 2) return -1;
+
+    u32 lba = fat32_cluster_to_lba(cluster);
+    return fat32_disk_write_sectors(lba, g_fat32_fs.sectors_per_cluster, buffer);
+}
+
+// Get the parent directory cluster from a path
+// Also extracts the filename component into 'filename' buffer
+static u32 fat32_get_parent_dir(const char *path, char *filename, int filename_size) {
+    if (!path || path[0] == '\0') return 0;
+
+    // Skip leading slash
+    if (*path == '/') path++;
+
+    // Find the last component
+    const char *last_slash = (void*)0;
+    const char *p = path;
+    while (*p) {
+        if (*p == '/') last_slash = p;
+        p++;
+    }
+
+    // Extract filename
+    const char *fname_start = last_slash ? (last_slash + 1) : path;
+    int i = 0;
+    while (*fname_start && i < filename_size - 1) {
+        filename[i++] = *fname_start++;
+    }
+    filename[i] = '\0';
+
+    // If no directory component, parent is root
+    if (!last_slash) {
+        return g_fat32_fs.root_cluster;
+    }
+
+    // Resolve parent directory path
+    // Build parent path (everything before last slash)
+    char parent_path[256];
+    int len = 0;
+    parent_path[len++] = '/';
+    p = path;
+    while (p < last_slash && len < 255) {
+        parent_path[len++] = *p++;
+    }
+    parent_path[len] = '\0';
+
+    fat32_dir_entry_t entry;
+    if (fat32_resolve_path(parent_path, &entry) != 0) {
+        return 0;  // Parent directory not found
+    }
+
+    if (!(entry.attributes & FAT32_ATTR_DIRECTORY)) {
+        return 0;  // Parent is not a directory
+    }
+
+    return fat32_entry_cluster(&entry);
+}
+
+// Find a free directory entry slot in a directory
+// Returns the sector LBA and entry offset within that sector
+// Also returns the cluster containing the entry
+static int fat32_find_free_dir_entry(u32 dir_cluster, u32 *out_sector_lba,
+                                     u32 *out_entry_offset, u32 *out_cluster) {
+    u8 sector_buffer[FAT32_SECTOR_SIZE];
+    u32 entries_per_sector = FAT32_SECTOR_SIZE / sizeof(fat32_dir_entry_t);
+    u32 current_cluster = dir_cluster;
+
+    while (!fat32_is_eoc(current_cluster) && current_cluster >= 2) {
+        u32 cluster_lba = fat32_cluster_to_lba(current_cluster);
+
+        // Check each sector in the cluster
+        for (u32 s = 0; s < g_fat32_fs.sectors_per_cluster; s++) {
+            u32 sector_lba = cluster_lba + s;
+
+            if (fat32_disk_read_sectors(sector_lba, 1, sector_buffer) != 0) {
+                return -1;
+            }
+
+            fat32_dir_entry_t *entries = (fat32_dir_entry_t *)sector_buffer;
+
+            for (u32 e = 0; e < entries_per_sector; e++) {
+                // Check for free entry (0x00 = end of dir, 0xE5 = deleted)
+                if (entries[e].name[0] == FAT32_DIR_ENTRY_END ||
+                    entries[e].name[0] == FAT32_DIR_ENTRY_FREE) {
+                    *out_sector_lba = sector_lba;
+                    *out_entry_offset = e * sizeof(fat32_dir_entry_t);
+                    *out_cluster = current_cluster;
+                    return 0;
+                }
+            }
+        }
+
+        // Move to next cluster
+        u32 next = fat32_next_cluster(current_cluster);
+        if (fat32_is_eoc(next)) {
+            // Need to allocate a new cluster for the directory
+            u32 new_cluster = fat32_alloc_cluster();
+            if (new_cluster == 0) {
+                return -1;  // No space
+            }
+
+            // Link the new cluster
+            if (fat32_write_fat_entry(current_cluster, new_cluster) != 0) {
+                return -1;
+            }
+
+            // Zero out the new cluster
+            u8 zero_buffer[FAT32_SECTOR_SIZE];
+            memset(zero_buffer, 0, FAT32_SECTOR_SIZE);
+            u32 new_lba = fat32_cluster_to_lba(new_cluster);
+            for (u32 s = 0; s < g_fat32_fs.sectors_per_cluster; s++) {
+                if (fat32_disk_write_sectors(new_lba + s, 1, zero_buffer) != 0) {
+                    return -1;
+                }
+            }
+
+            // Return first entry of new cluster
+            *out_sector_lba = new_lba;
+            *out_entry_offset = 0;
+            *out_cluster = new_cluster;
+            return 0;
+        }
+        current_cluster = next;
+    }
+
+    return -1;  // No free entry found
+}
+
+// Create a new file (empty)
+// Returns 0 on success, -1 on error
+static int fat32_create_file_claimed(const char *path) {
+    if (!g_fat32_fs.initialized) {
+        return -1;
+    }
+
+    // Check if file already exists
+    if (fat32_exists(path)) {
+        return -2;  // File already exists
+    }
+
+    // Get parent directory and filename
+    char filename[13];
+    u32 parent_cluster = fat32_get_parent_dir(path, filename, sizeof(filename));
+    if (parent_cluster == 0) {
+        return -3;  // Parent directory not found
+    }
+
+    // Convert filename to 8.3 format
+    u8 name83[11];
+    if (fat32_name_to_83(filename, name83) != 0) {
+        return -4;  // Invalid filename
+    }
+
+    // Find a free directory entry
+    u32 sector_lba, entry_offset, entry_cluster;
+    if (fat32_find_free_dir_entry(parent_cluster, &sector_lba, &entry_offset, &entry_cluster) != 0) {
+        return -5;  // No free directory entry
+    }
+
+    // Read the sector containing the entry
+    u8 sector_buffer[FAT32_SECTOR_SIZE];
+    if (fat32_disk_read_sectors(sector_lba, 1, sector_buffer) != 0) {
+        return -6;
+    }
+
+    // Create the directory entry
+    fat32_dir_entry_t *entry = (fat32_dir_entry_t *)(sector_buffer + entry_offset);
+    memset(entry, 0, sizeof(fat32_dir_entry_t));
+
+    // Set filename
+    memcpy(entry->name, name83, 11);
+
+    // Set attributes (archive bit for new files)
+    entry->attributes = FAT32_ATTR_ARCHIVE;
+
+    // Set timestamps (simplified - use fixed values)
+    // Date format: bits 0-4 = day (1-31), bits 5-8 = month (1-12), bits 9-15 = year from 1980
+    // Time format: bits 0-4 = seconds/2, bits 5-10 = minutes, bits 11-15 = hours
+    u16 date = (45 << 9) | (12 << 5) | 9;   // Dec 9, 2025 (2025-1980=45)
+    u16 time = (12 << 11) | (0 << 5) | 0;   // 12:00:00
+
+    entry->creation_date = date;
+    entry->creation_time = time;
+    entry->write_date = date;
+    entry->write_time = time;
+    entry->last_access_date = date;
+
+    // For an empty file, no cluster allocated yet (cluster = 0)
+    entry->first_cluster_high = 0;
+    entry->first_cluster_low = 0;
+    entry->file_size = 0;
+
+    // Write the sector back
+    if (fat32_disk_write_sectors(sector_lba, 1, sector_buffer) != 0) {
+        return -7;
+    }
+
+    return 0;
+}
+
+int fat32_create_file(const char *path) {
+    fat32_claim();
+    int result = fat32_create_file_claimed(path);
+    fat32_release();
+    return result;
+}
+
+// Delete a file
+// Returns 0 on success, -1 on error
+static int fat32_delete_file_claimed(const char *path) {
+    if (!g_fat32_fs.initialized) {
+        return -1;
+    }
+
+    // Resolve the file path
+    fat32_dir_entry_t entry;
+    if (fat32_resolve_path(path, &entry) != 0) {
+        return -2;  // File not found
+    }
+
+    // Cannot delete directories with this function
+    if (entry.attributes & FAT32_ATTR_DIRECTORY) {
+        return -3;
+    }
+
+    // Get parent directory
+    char filename[13];
+    u32 parent_cluster = fat32_get_parent_dir(path, filename, sizeof(filename));
+    if (parent_cluster == 0) {
+        return -4;
+    }
+
+    // Convert filename to 8.3
+    u8 name83[11];
+    if (fat32_name_to_83(filename, name83) != 0) {
+        return -5;
+    }
+
+    // Find the entry in the parent directory
+    u8 sector_buffer[FAT32_SECTOR_SIZE];
+    u32 entries_per_sector = FAT32_SECTOR_SIZE / sizeof(fat32_dir_entry_t);
+    u32 current_cluster = parent_cluster;
+
+    while (!fat32_is_eoc(current_cluster) && current_cluster >= 2) {
+        u32 cluster_lba = fat32_cluster_to_lba(current_cluster);
+
+        for (u32 s = 0; s < g_fat32_fs.sectors_per_cluster; s++) {
+            u32 sector_lba = cluster_lba + s;
+
+            if (fat32_disk_read_sectors(sector_lba, 1, sector_buffer) != 0) {
+                return -6;
+            }
+
+            fat32_dir_entry_t *entries = (fat32_dir_entry_t *)sector_buffer;
+
+            for (u32 e = 0; e < entries_per_sector; e++) {
+                if (entries[e].name[0] == FAT32_DIR_ENTRY_END) {
+                    return -7;  // Reached end without finding file
+                }
+
+                if (entries[e].name[0] == FAT32_DIR_ENTRY_FREE) {
+                    continue;  // Skip deleted entries
+                }
+
+                if (memcmp(entries[e].name, name83, 11) == 0) {
+                    // Found the entry
+                    u32 first_cluster = fat32_entry_cluster(&entries[e]);
+
+                    // Free the cluster chain
+                    if (first_cluster >= 2) {
+                        fat32_free_chain(first_cluster);
+                    }
+
+                    // Mark entry as deleted
+                    entries[e].name[0] = FAT32_DIR_ENTRY_FREE;
+
+                    // Write sector back
+                    if (fat32_disk_write_sectors(sector_lba, 1, sector_buffer) != 0) {
+                        return -8;
+                    }
+
+                    return 0;
+                }
+            }
+        }
+
+        current_cluster = fat32_next_cluster(current_cluster);
+    }
+
+    return -9;  // Entry not found
+}
+
+int fat32_delete_file(const char *path) {
+    fat32_claim();
+    int result = fat32_delete_file_claimed(path);
+    fat32_release();
+    return result;
+}
+
+// Write data to a file (overwrites existing content)
+// Returns bytes written, or -1 on error
+static int fat32_write_file_claimed(const char *path, const void *data, u32 size) {
+    if (!g_fat32_fs.initialized) {
+        return -1;
+    }
+
+    // For now, only support writing to new or existing empty files
+    // Full implementation would handle partial writes, appending, etc.
+
+    fat32_dir_entry_t entry;
+    if (fat32_resolve_path(path, &entry) != 0) {
+        // File doesn't exist, create it first
+        if (fat32_create_file(path) != 0) {
+            return -1;
+        }
+        if (fat32_resolve_path(path, &entry) != 0) {
+            return -1;
+        }
+    }
+
+    if (entry.attributes & FAT32_ATTR_DIRECTORY) {
+        return -2;  // Cannot write to directory
+    }
+
+    // Get parent directory info to update the entry later
+    char filename[13];
+    u32 parent_cluster = fat32_get_parent_dir(path, filename, sizeof(filename));
+    if (parent_cluster == 0) {
+        return -3;
+    }
+
+    u8 name83[11];
+    fat32_name_to_83(filename, name83);
+
+    // Free existing cluster chain if file has content
+    u32 old_cluster = fat32_entry_cluster(&entry);
+    if (old_cluster >= 2) {
+        fat32_free_chain(old_cluster);
+    }
+
+    // Allocate clusters for new data
+    u32 bytes_per_cluster = g_fat32_fs.bytes_per_cluster;
+    u32 clusters_needed = size > 0 ? (size + bytes_per_cluster - 1) >> g_fat32_fs.cluster_shift : 0;
+
+    u32 first_cluster = 0;
+    u32 prev_cluster = 0;
+
+    const u8 *src = (const u8 *)data;
+    u32 bytes_remaining = size;
+
+    for (u32 i = 0; i < clusters_needed; i++) {
+        u32 cluster = fat32_alloc_cluster();
+        if (cluster == 0) {
+            // Out of space - free what we allocated
+            if (first_cluster >= 2) {
+                fat32_free_chain(first_cluster);
+            }
+            return -4;
+        }
+
+        if (first_cluster == 0) {
+            first_cluster = cluster;
+        }
+
+        // Link to previous cluster
+        if (prev_cluster >= 2) {
+            fat32_write_fat_entry(prev_cluster, cluster);
+        }
+        prev_cluster = cluster;
+
+        // Write data to cluster
+        u8 *cluster_buffer = g_cluster_buffer;     // Too big for a coroutine stack
+        u32 bytes_to_write = bytes_remaining < bytes_per_cluster ? bytes_remaining : bytes_per_cluster;
+
+        memset(cluster_buffer, 0, bytes_per_cluster);
+        memcpy(cluster_buffer, src, bytes_to_write);
+
+        if (fat32_write_cluster_data(cluster, cluster_buffer) != 0) {
+            fat32_free_chain(first_cluster);
+            return -5;
+        }
+
+        src += bytes_to_write;
+        bytes_remaining -= bytes_to_write;
+    }
+
+    // Update directory entry with new cluster and size
+    u8 sector_buffer[FAT32_SECTOR_SIZE];
+    u32 entries_per_sector = FAT32_SECTOR_SIZE / sizeof(fat32_dir_entry_t);
+    u32 current_cluster = parent_cluster;
+
+    while (!fat32_is_eoc(current_cluster) && current_cluster >= 2) {
+        u32 cluster_lba = fat32_cluster_to_lba(current_cluster);
+
+        for (u32 s = 0; s < g_fat32_fs.sectors_per_cluster; s++) {
+            u32 sector_lba = cluster_lba + s;
+
+            if (fat32_disk_read_sectors(sector_lba, 1, sector_buffer) != 0) {
+                return -6;
+            }
+
+            fat32_dir_entry_t *entries = (fat32_dir_entry_t *)sector_buffer;
+
+            for (u32 e = 0; e < entries_per_sector; e++) {
+                if (memcmp(entries[e].name, name83, 11) == 0) {
+                    // Update entry
+                    entries[e].first_cluster_high = (first_cluster >> 16) & 0xFFFF;
+                    entries[e].first_cluster_low = first_cluster & 0xFFFF;
+                    entries[e].file_size = size;
+
+                    // Update modification time
+                    u16 date = (45 << 9) | (12 << 5) | 9;
+                    u16 time = (12 << 11) | (0 << 5) | 0;
+                    entries[e].write_date = date;
+                    entries[e].write_time = time;
+
+                    // Write sector back
+                    if (fat32_disk_write_sectors(sector_lba, 1, sector_buffer) != 0) {
+                        return -7;
+                    }
+
+                    return size;
+                }
+            }
+        }
+
+        current_cluster = fat32_next_cluster(current_cluster);
+    }
+
+    return -8;  // Entry not found (shouldn't happen)
+}
+
+int fat32_write_file(const char *path, const void *data, u32 size) {
+    fat32_claim();
+    int result = fat32_write_file_claimed(path, data, size);
+    fat32_release();
+    return result;
+}
@@ -1,6 +1,10 @@
 #include "package.h"
+#include "io/uart.h"
 
 void exit(void) {
+    // Let queued console output reach the host first
+    uart_flush();
+
     // Use ARM semihosting to exit QEMU
     // SYS_EXIT = 0x18, ADP_Stopped_ApplicationExit = 0x20026
     __asm__ volatile (
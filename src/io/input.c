@@ -0,0 +1,103 @@
+/*
+ * Console input: keyboard event queue and blocking key reads
+ */
+
+#include "input.h"
+#include "uart.h"
+#include <drivers/ps2Keyboard.h>
+#include <sys/coroutine.h>
+#include <sys/irq.h>
+#include <sys/thread.h>
+#include <sys/tick.h>
+
+// Keyboard events; the KMI IRQ produces, input_poll() consumes
+static key_event_t key_queue[INPUT_QUEUE_SIZE];
+static volatile u32 key_head = 0;
+static volatile u32 key_tail = 0;
+
+static wait_queue_t input_wq = WAIT_QUEUE_INIT;
+
+void input_init(void) {
+#if CONFIG_PS2
+    ps2_init();
+#endif
+}
+
+// ============================================================================
+// Producers
+// ============================================================================
+
+void input_push(u16 key, u8 mods) {
+    u32 head = key_head;
+    if (head - key_tail < INPUT_QUEUE_SIZE) {
+        key_event_t *ev = &key_queue[head & (INPUT_QUEUE_SIZE - 1)];
+        ev->tick = ticks;
+        ev->key = key;
+        ev->mods = mods;
+        ev->source = KEY_SRC_PS2;
+        key_head = head + 1;
+    }
+    input_wake();
+}
+
+void input_wake(void) {
+    thread_wake_all(&input_wq);
+}
+
+// ============================================================================
+// Consumers
+// ============================================================================
+
+int input_has_key(void) {
+#if CONFIG_PS2
+    ps2_poll();
+#endif
+    return key_head != key_tail || uart_has_data();
+}
+
+static int input_ready(void *arg) {
+    (void)arg;
+    return input_has_key();
+}
+
+int input_poll(key_event_t *ev) {
+#if CONFIG_PS2
+    ps2_poll();
+#endif
+
+    if (key_head != key_tail) {
+        *ev = key_queue[key_tail & (INPUT_QUEUE_SIZE - 1)];
+        key_tail++;
+        return 1;
+    }
+
+    int c = uart_read();
+    if (c < 0) return 0;
+
+    ev->tick = ticks;
+    ev->key = (u16)c;
+    ev->mods = 0;
+    ev->source = KEY_SRC_UART;
+    return 1;
+}
+
+int input_getkey(void) {
+    key_event_t ev;
+
+    while (!input_poll(&ev)) {
+        // Coroutines only run while someone pumps them, so keep polling
+        // if any exist; otherwise sleep until an input IRQ wakes us.
+        if (!thread_current() || co_self() || co_active()) {
+            co_await_io(input_ready, 0);
+            continue;
+        }
+
+        u32 flags = irq_save();
+        if (!input_has_key()) {
+            thread_wait(&input_wq);
+        }
+        irq_restore(flags);
+    }
+
+    return ev.key;
+}
@@ -0,0 +1,61 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+/*
+ * Console input for Spark
+ *
+ * Keys from the PS/2 keyboard arrive as decoded events from the KMI
+ * interrupt; bytes from the UART come out of its RX ring. input_getkey()
+ * merges both and puts the calling thread to sleep until one arrives, so
+ * the CPU idles (WFI) while waiting for a keypress.
+ */
+
+#include <package.h>
+
+// Key codes: ASCII below 0x100, special keys above
+#define KEY_UP          0x100
+#define KEY_DOWN        0x101
+#define KEY_LEFT        0x102
+#define KEY_RIGHT       0x103
+#define KEY_HOME        0x104
+#define KEY_END         0x105
+#define KEY_DELETE      0x106
+#define KEY_PGUP        0x107
+#define KEY_PGDN        0x108
+
+#define KEY_IS_SPECIAL(k)   ((k) >= 0x100)
+
+// Modifiers held when the key was pressed
+#define KEY_MOD_SHIFT   (1 << 0)
+#define KEY_MOD_CTRL    (1 << 1)
+
+// Where a key came from
+#define KEY_SRC_PS2     0
+#define KEY_SRC_UART    1
+
+#define INPUT_QUEUE_SIZE    64      // Power of two
+
+typedef struct {
+    u32 tick;                   // Kernel tick when the key arrived
+    u16 key;
+    u8 mods;
+    u8 source;
+} key_event_t;
+
+// Enable the keyboard interrupt
+void input_init(void);
+
+// Producers (IRQ context): queue a decoded key / note new UART bytes
+void input_push(u16 key, u8 mods);
+void input_wake(void);
+
+// Non-zero if a key is waiting
+int input_has_key(void);
+
+// Take the next key event without waiting; returns 0 if there is none
+int input_poll(key_event_t *ev);
+
+// Wait for the next key and return its code
+int input_getkey(void);
+
+#endif
@@ -1,41 +1,31 @@
 #include "uart.h"
-#include <drivers/graphicsDriver.h>
 #include <package.h>
+#include <lib/format.h>
+#if CONFIG_GRAPHICS
+#include <drivers/graphicsDriver.h>
+#include <sys/bootinfo.h>
+#endif
 
+#if CONFIG_GRAPHICS
 // Graphics mode flag (0 = UART only, 1 = Graphics + UART)
 static int graphics_enabled = 0;
+#endif
 
-// Software division helper for ARM (no hardware divider)
-static unsigned int soft_div(unsigned int n, unsigned int d) {
-    unsigned int q = 0;
-    unsigned int r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-            q |= (1U << i);
-        }
-    }
-    return q;
-}
-
-static unsigned int soft_mod(unsigned int n, unsigned int d) {
-    unsigned int r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-        }
-    }
-    return r;
-}
-
-// Initialize graphics mode
-void initGraphics(void) {
-    gfx_init();
+// Initialize graphics mode (headless builds have none, and the `headless`
+// boot option skips it). Returns 0 if the screen is up.
+int initGraphics(void) {
+#if CONFIG_GRAPHICS
+    if (boot_option("headless", 0, 0)) return -1;
+    if (gfx_init(GFX_MODE_PAL8) != 0) return -1;
     graphics_enabled = 1;
+    return 0;
+#else
+    return -1;
+#endif
 }
 
+#if CONFIG_GRAPHICS
+
 // ANSI escape sequence parser state
 static int ansi_state = 0;  // 0=normal, 1=got ESC, 2=got [, 3=got ?
 static int ansi_params[8];
@@ -50,6 +40,24 @@ static void ansi_reset(void) {
     for (int i = 0; i < 8; i++) ansi_params[i] = 0;
 }
 
+// Count parameter i, where a missing or zero count means 1
+static int ansi_count(int i) {
+    return (i < ansi_param_count && ansi_params[i] > 0) ? ansi_params[i] : 1;
+}
+
+// Move the cursor by (dx, dy), stopping at the screen edges
+static void ansi_move(int dx, int dy) {
+    int x, y;
+    gfx_get_cursor(&x, &y);
+    x += dx;
+    y += dy;
+    if (x < 0) x = 0;
+    if (x >= SCREEN_COLS) x = SCREEN_COLS - 1;
+    if (y < 0) y = 0;
+    if (y >= gfx_text_rows()) y = gfx_text_rows() - 1;
+    gfx_set_cursor(x, y);
+}
+
 // Process completed ANSI sequence
 static void ansi_execute(char cmd) {
     // Store final parameter
@@ -58,6 +66,25 @@ static void ansi_execute(char cmd) {
     }
     
     switch (cmd) {
+        case 'A':  // Cursor up
+            ansi_move(0, -ansi_count(0));
+            break;
+        case 'B':  // Cursor down
+            ansi_move(0, ansi_count(0));
+            break;
+        case 'C':  // Cursor forward
+            ansi_move(ansi_count(0), 0);
+            break;
+        case 'D':  // Cursor back
+            ansi_move(-ansi_count(0), 0);
+            break;
+        case 'G':  // Cursor to column
+            {
+                int x, y;
+                gfx_get_cursor(&x, &y);
+                ansi_move(ansi_count(0) - 1 - x, 0);
+            }
+            break;
         case 'H':  // Cursor position (row;col)
         case 'f':
             {
@@ -67,12 +94,42 @@ static void ansi_execute(char cmd) {
             }
             break;
         case 'J':  // Erase display
-            if (ansi_params[0] == 2) {
+            if (ansi_params[0] == 0) {
+                gfx_clear_to_eos();
+            } else if (ansi_params[0] == 1) {
+                gfx_clear_to_bos();
+            } else if (ansi_params[0] == 2) {
                 gfx_clear();  // Clear entire screen
             }
             break;
         case 'K':  // Erase line
-            gfx_clear_to_eol();  // Clear to end of line
+            if (ansi_params[0] == 0) {
+                gfx_clear_to_eol();
+            } else if (ansi_params[0] == 1) {
+                gfx_clear_to_bol();
+            } else if (ansi_params[0] == 2) {
+                gfx_clear_line();
+            }
+            break;
+        case 'L':  // Insert lines
+            gfx_insert_lines(ansi_count(0));
+            break;
+        case 'M':  // Delete lines
+            gfx_delete_lines(ansi_count(0));
+            break;
+        case 'S':  // Scroll region up
+            gfx_scroll_region(ansi_count(0));
+            break;
+        case 'T':  // Scroll region down
+            gfx_scroll_region(-ansi_count(0));
+            break;
+        case 'r':  // Set scroll region (top;bottom), cursor home
+            {
+                int top = ansi_params[0] > 0 ? ansi_params[0] - 1 : 0;
+                int bottom = (ansi_param_count > 1 && ansi_params[1] > 0) ? ansi_params[1] - 1 : gfx_text_rows() - 1;
+                gfx_set_scroll_region(top, bottom);
+                gfx_set_cursor(0, 0);
+            }
             break;
         case 'm':  // SGR - Select Graphic Rendition
             for (int i = 0; i < ansi_param_count; i++) {
@@ -97,145 +154,168 @@ static void ansi_execute(char cmd) {
     ansi_reset();
 }
 
-// writeOut - outputs to both UART and graphics (if enabled)
-// Parses ANSI escape sequences for graphics output
-
-void writeOut(const char *s) {
-    while (*s) {
-        char c = *s++;
-        
-        // Always write to UART (it handles ANSI natively)
-        while (*UART0_FR & UART0_FR_TXFF);
-        *UART0_DR = (unsigned int)(unsigned char)c;
-
-        // Handle graphics with ANSI parsing
-        if (graphics_enabled) {
-            switch (ansi_state) {
-                case 0:  // Normal state
-                    if (c == '\033') {
-                        ansi_state = 1;  // Got ESC
-                    } else {
-                        gfx_putchar((unsigned char)c);
-                    }
-                    break;
-                    
-                case 1:  // Got ESC
-                    if (c == '[') {
-                        ansi_state = 2;  // Got CSI
-                        ansi_param_count = 0;
-                        ansi_current_param = 0;
-                        for (int i = 0; i < 8; i++) ansi_params[i] = 0;
-                    } else {
-                        // Not a CSI sequence, output as-is
-                        gfx_putchar('\033');
-                        gfx_putchar((unsigned char)c);
-                        ansi_state = 0;
-                    }
-                    break;
-                    
-                case 2:  // Inside CSI sequence
-                    if (c == '?') {
-                        ansi_state = 3;  // Private mode sequence
-                    } else if (c >= '0' && c <= '9') {
-                        ansi_current_param = ansi_current_param * 10 + (c - '0');
-                    } else if (c == ';') {
-                        if (ansi_param_count < 8) {
-                            ansi_params[ansi_param_count++] = ansi_current_param;
-                        }
-                        ansi_current_param = 0;
-                    } else if (c >= 'A' && c <= 'Z') {
-                        ansi_execute(c);
-                    } else if (c >= 'a' && c <= 'z') {
-                        ansi_execute(c);
-                    } else {
-                        // Unknown, reset
-                        ansi_reset();
-                    }
-                    break;
-                    
-                case 3:  // Private mode (ESC[?)
-                    if (c >= '0' && c <= '9') {
-                        ansi_current_param = ansi_current_param * 10 + (c - '0');
-                    } else if (c == 'l' || c == 'h') {
-                        ansi_execute(c);
-                    } else {
-                        ansi_reset();
-                    }
-                    break;
+// Feed one byte of graphics output through the ANSI parser
+static void gfx_ansi_putc(char c) {
+    switch (ansi_state) {
+        case 0:  // Normal state
+            if (c == '\033') {
+                ansi_state = 1;  // Got ESC
+            } else {
+                gfx_putchar((unsigned char)c);
             }
-        }
+            break;
+            
+        case 1:  // Got ESC
+            if (c == '[') {
+                ansi_state = 2;  // Got CSI
+                ansi_param_count = 0;
+                ansi_current_param = 0;
+                for (int i = 0; i < 8; i++) ansi_params[i] = 0;
+            } else if (c == 'D') {  // Index
+                gfx_linefeed();
+                ansi_state = 0;
+            } else if (c == 'M') {  // Reverse index
+                gfx_reverse_index();
+                ansi_state = 0;
+            } else {
+                // Not a CSI sequence, output as-is
+                gfx_putchar('\033');
+                gfx_putchar((unsigned char)c);
+                ansi_state = 0;
+            }
+            break;
+            
+        case 2:  // Inside CSI sequence
+            if (c == '?') {
+                ansi_state = 3;  // Private mode sequence
+            } else if (c >= '0' && c <= '9') {
+                ansi_current_param = ansi_current_param * 10 + (c - '0');
+            } else if (c == ';') {
+                if (ansi_param_count < 8) {
+                    ansi_params[ansi_param_count++] = ansi_current_param;
+                }
+                ansi_current_param = 0;
+            } else if (c >= 'A' && c <= 'Z') {
+                ansi_execute(c);
+            } else if (c >= 'a' && c <= 'z') {
+                ansi_execute(c);
+            } else {
+                // Unknown, reset
+                ansi_reset();
+            }
+            break;
+            
+        case 3:  // Private mode (ESC[?)
+            if (c >= '0' && c <= '9') {
+                ansi_current_param = ansi_current_param * 10 + (c - '0');
+            } else if (c == 'l' || c == 'h') {
+                ansi_execute(c);
+            } else {
+                ansi_reset();
+            }
+            break;
     }
 }
 
-// writeOutNum
+#endif // CONFIG_GRAPHICS
 
-void writeOutNum(long num) {
-    char buffer[20];
-    int i = 0;
+// writeOutN - outputs n bytes to both UART and graphics (if enabled)
+// The UART gets the whole span at once; the cell grid gets plain text in
+// runs and only escape sequences go through the parser byte by byte.
 
-    if (num == 0) {
-        writeOut("0");
-        return;
-    }
+void writeOutN(const char *s, size_t n) {
+    if (n == 0) return;
 
-    if (num < 0) {
-        writeOut("-");
-        num = -num;
-    }
+    // Always write to UART (it handles ANSI natively); queued, not waited on
+    uart_write(s, n);
 
-    while (num > 0) {
-        buffer[i++] = soft_mod(num, 10) + '0';
-        num = soft_div(num, 10);
-    }
-    for (int j = i - 1; j >= 0; j--) {
-        char c[2] = {buffer[j], '\0'};
-        writeOut(c);
+#if CONFIG_GRAPHICS
+    if (!graphics_enabled) return;
+
+    size_t i = 0;
+    while (i < n) {
+        if (ansi_state == 0) {
+            size_t start = i;
+            while (i < n && s[i] != '\033') i++;
+            if (i > start) gfx_write(s + start, (int)(i - start));
+            if (i == n) break;
+        }
+        gfx_ansi_putc(s[i++]);
     }
+
+    // Draw only the cells this span actually changed
+    gfx_flush();
+#endif
 }
 
-// breakline
+// writeOut - outputs a string to both UART and graphics (if enabled)
+// Parses ANSI escape sequences for graphics output
 
-void BreakLine(int times) {
-    for (int i = 0; i < times; i++) {
-        writeOut("\n");
-    }
+void writeOut(const char *s) {
+    writeOutN(s, strlen(s));
 }
 
-// strcmp - compare two strings
+// writeOutNum
+
+void writeOutNum(long num) {
+    char buffer[12];
+    char *end = buffer + sizeof(buffer);
+    char *p = fmt_u32(end, num < 0 ? -(unsigned long)num : (unsigned long)num);
 
-int strcmp(const char *s1, const char *s2) {
-    while (*s1 && (*s1 == *s2)) {
-        s1++;
-        s2++;
+    if (num < 0) {
+        *--p = '-';
     }
-    return *(unsigned char *)s1 - *(unsigned char *)s2;
+    writeOutN(p, end - p);
 }
 
-// strncmp - compare first n characters of two strings
+// ============================================================================
+// kprintf
+// ============================================================================
+
+// Formatted output is gathered here and written in spans of up to this size
+#define KPRINTF_BUF_SIZE 128
+
+typedef struct {
+    char buf[KPRINTF_BUF_SIZE];
+    size_t len;
+} kprintf_out_t;
+
+static void kprintf_sink(void *ctx, const char *s, size_t n) {
+    kprintf_out_t *out = (kprintf_out_t *)ctx;
 
-int strncmp(const char *s1, const char *s2, size_t n) {
-    while (n > 0 && *s1 && (*s1 == *s2)) {
-        s1++;
-        s2++;
-        n--;
+    // Long spans skip the buffer
+    if (n > sizeof(out->buf) - out->len) {
+        writeOutN(out->buf, out->len);
+        out->len = 0;
+        if (n >= sizeof(out->buf)) {
+            writeOutN(s, n);
+            return;
+        }
     }
-    if (n == 0) return 0;
-    return *(unsigned char *)s1 - *(unsigned char *)s2;
+    memcpy(out->buf + out->len, s, n);
+    out->len += n;
 }
 
-// startsWith - check if string starts with prefix
+// kprintf - formatted console output (see lib/format.h for conversions)
+// Returns the number of characters written
 
-int startsWith(const char *str, const char *prefix) {
-    while (*prefix) {
-        if (*str++ != *prefix++) return 0;
-    }
-    return 1;
+int kprintf(const char *fmt, ...) {
+    kprintf_out_t out;
+    out.len = 0;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = kvformat(kprintf_sink, &out, fmt, ap);
+    va_end(ap);
+
+    writeOutN(out.buf, out.len);
+    return n;
 }
 
-// strcpy - copy string from src to dest
+// breakline
 
-char *strcpy(char *dest, const char *src) {
-    char *original = dest;
-    while ((*dest++ = *src++));
-    return original;
+void BreakLine(int times) {
+    for (int i = 0; i < times; i++) {
+        writeOut("\n");
+    }
 }
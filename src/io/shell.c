@@ -3,139 +3,189 @@
 #include "print.h"
 #include "shell.h"
 
-  // Forward declaration
-
-// External program declarations
-int prog_rm(const char *path);
-int prog_cat(const char *path);
-int prog_cp(const char *src, const char *dst);
-int prog_mv(const char *src, const char *dst);
-int prog_touch(const char *path);
-void prog_setup(void);
-void prog_vi(const char *filename);
-
-// Current working directory (simple implementation)
-static char current_dir[256] = "/";
-
-// Helper to extract argument from command
-static const char* get_arg(const char *cmd, const char *prefix) {
-    int prefix_len = 0;
-    while (prefix[prefix_len]) prefix_len++;
-
-    // Skip prefix and space
-    const char *arg = cmd + prefix_len;
-    while (*arg == ' ') arg++;
-
-    return (*arg) ? arg : (void*)0;
+// Command descriptors (linker.ld)
+extern const sh_command_t __shell_commands_start[];
+extern const sh_command_t __shell_commands_end[];
+
+// Open-addressed name table, built on first use. Twice the size of the
+// command count keeps probes short.
+#define SH_HASH_SIZE        (SH_MAX_COMMANDS * 2)  // Power of two
+
+// The limit is checked on the section size in linker.ld
+_Static_assert(sizeof(sh_command_t) == 20,
+               "linker.ld assumes 20-byte shell command descriptors");
+
+static const sh_command_t *sh_hash[SH_HASH_SIZE];
+static const sh_command_t *sh_sorted[SH_MAX_COMMANDS];  // By name, for help
+static int sh_count = 0;
+static int sh_ready = 0;
+
+// FNV-1a
+static u32 sh_hash_name(const char *s) {
+    u32 h = 2166136261u;
+    while (*s) {
+        h ^= (u8)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void sh_table_init(void) {
+    for (const sh_command_t *c = __shell_commands_start; c < __shell_commands_end; c++) {
+        u32 i = sh_hash_name(c->name) & (SH_HASH_SIZE - 1);
+        while (sh_hash[i] && strcmp(sh_hash[i]->name, c->name) != 0) {
+            i = (i + 1) & (SH_HASH_SIZE - 1);
+        }
+        if (sh_hash[i]) continue;       // Registered twice: first one wins
+        sh_hash[i] = c;
+
+        // Insertion sort; there are only a few dozen commands
+        int j = sh_count++;
+        while (j > 0 && strcmp(sh_sorted[j - 1]->name, c->name) > 0) {
+            sh_sorted[j] = sh_sorted[j - 1];
+            j--;
+        }
+        sh_sorted[j] = c;
+    }
+    sh_ready = 1;
+}
+
+static const sh_command_t *sh_find(const char *name) {
+    if (!sh_ready) sh_table_init();
+
+    u32 i = sh_hash_name(name) & (SH_HASH_SIZE - 1);
+    while (sh_hash[i]) {
+        if (strcmp(sh_hash[i]->name, name) == 0) return sh_hash[i];
+        i = (i + 1) & (SH_HASH_SIZE - 1);
+    }
+    return 0;
+}
+
+// Split a line in place on spaces; double quotes group words
+static int sh_tokenize(char *line, char **argv, int max) {
+    int argc = 0;
+    char *p = line;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p) break;
+        if (argc == max) break;
+
+        char *out = p;
+        argv[argc++] = out;
+        int quoted = 0;
+        while (*p && (quoted || (*p != ' ' && *p != '\t'))) {
+            if (*p == '"') {
+                quoted = !quoted;
+                p++;
+                continue;
+            }
+            *out++ = *p++;
+        }
+        if (*p) p++;
+        *out = '\0';
+    }
+
+    argv[argc] = 0;
+    return argc;
 }
 
 void sh_start(void) {
-    char input_buf[128];
+    char input_buf[SH_LINE_MAX];
     while (1) {
         writeOut("> ");
         readline(input_buf, sizeof(input_buf));
 
         int ret = sh_exec(input_buf);
-        if (ret == 66) {
+        if (ret == SH_EXIT) {
             break;
         }
     }
 }
 
 int sh_exec(const char *cmd) {
-    if (strcmp(cmd, "help") == 0) {
-        print(
-            "COMMANDS\n"
-            "  SYSTEM\n"
-            "    help          Show this help menu\n"
-            "    about         Show info about Spark\n"
-            "    exit          Shutdown Spark\n"
-            "    setup/ssw     Run setup wizard\n"
-            "\n"
-            "  FILES\n"
-            "    ls [path]     List directory contents\n"
-            "    cat <file>    Display file contents\n"
-            "    mkf <file>    Create empty file\n"
-            "    vi <file>     Edit file with vi editor\n"
-            "\n"
-        );
-    }
-    else if (strcmp(cmd, "about") == 0) {
-        print(
-            "Spark is developed by syntaxMORG0 and Samuraien2\n"
-            "You can find the Spark project at https://github.com/OpenSBCs/Spark\n"
-        );
-    }
-    else if (strcmp(cmd, "exit") == 0) {
-        return 66;
-    }
-    else if (strcmp(cmd, "setup") == 0 || strcmp(cmd, "ssw") == 0) {
-        prog_setup();
-    }
-    else if (strcmp(cmd, "ls") == 0) {
-        if (!fat32_is_initialized()) {
-            writeOut("Error: Filesystem not mounted. Run 'setup' then 'part'.\n");
-        } else {
-            fat32_list_dir("/");
-        }
-    }
-    else if (startsWith(cmd, "ls ")) {
-        if (!fat32_is_initialized()) {
-            writeOut("Error: Filesystem not mounted. Run 'setup' then 'part'.\n");
-        } else {
-            const char *path = get_arg(cmd, "ls");
-            if (path) {
-                fat32_list_dir(path);
-            } else {
-                fat32_list_dir("/");
-            }
-        }
-    }
-    // Builtin: clear
-    else if (strcmp(cmd, "clear") == 0) {
-        writeOut("\033[2J\033[H");  // ANSI escape codes: clear screen and move cursor to home
-    }
-    // External program: cat
-
-    else if (startsWith(cmd, "cat ")) {
-        const char *path = get_arg(cmd, "cat");
-        if (path) {
-            if (!fat32_is_initialized()) {
-                writeOut("Error: Filesystem not mounted. Run 'setup' then 'part'.\n");
-            } else {
-                return prog_cat(path);
-            }
-        } else {
-            writeOut("Usage: cat <filename>\n");
-        }
-    }
-    else if (startsWith(cmd, "mkf ")) {
-        const char *path = get_arg(cmd, "touch");
-        if (path) {
-            if (!fat32_is_initialized()) {
-                writeOut("Error: Filesystem not mounted. Run 'setup' first.\n");
-            } else {
-                return prog_touch(path);
-            }
-        } else {
-            writeOut("Usage: touch <filename>\n");
-        }
+    char line[SH_LINE_MAX];
+    char *argv[SH_MAX_ARGS + 1];
+
+    size_t len = strlen(cmd);
+    if (len >= sizeof(line)) len = sizeof(line) - 1;
+    memcpy(line, cmd, len);
+    line[len] = '\0';
+
+    int argc = sh_tokenize(line, argv, SH_MAX_ARGS);
+    if (argc == 0) return 0;
+
+    const sh_command_t *c = sh_find(argv[0]);
+    if (!c) {
+        print("Invalid command: ", argv[0], "\n");
+        return 0;
     }
-    // vi editor
-    else if (strcmp(cmd, "vi") == 0) {
-        prog_vi((void*)0);  // Open vi with no file
+
+    if ((c->flags & SH_NEEDS_FS) && !fat32_is_initialized()) {
+        writeOut("Error: Filesystem not mounted. Run 'setup' then 'part'.\n");
+        return 1;
     }
-    else if (startsWith(cmd, "vi ")) {
-        const char *path = get_arg(cmd, "vi");
-        if (path) {
-            prog_vi(path);
-        } else {
-            prog_vi((void*)0);
+
+    return c->main(argc, argv);
+}
+
+// ============================================================================
+// Builtins
+// ============================================================================
+
+static const char *const sh_group_names[SH_GROUPS] = { "SYSTEM", "FILES", "DISK" };
+
+static int sh_help(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    if (!sh_ready) sh_table_init();
+
+    writeOut("COMMANDS\n");
+    for (int g = 0; g < SH_GROUPS; g++) {
+        kprintf("  %s\n", sh_group_names[g]);
+        for (int i = 0; i < sh_count; i++) {
+            const sh_command_t *c = sh_sorted[i];
+            if ((int)(c->flags & SH_GROUP_MASK) != g) continue;
+
+            char synopsis[32];
+            ksnprintf(synopsis, sizeof(synopsis), "%s%s%s", c->name,
+                      c->usage[0] ? " " : "", c->usage);
+            kprintf("    %-18s%s\n", synopsis, c->help);
         }
+        writeOut("\n");
     }
-    else if (cmd[0] != '\0') {
-        print("Invalid command: ", cmd, "\n");
-    }
+    return 0;
+}
+SHELL_COMMAND(help, sh_help, SH_SYSTEM, "", "Show this help menu");
+
+static int sh_about(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    print(
+        "Spark is developed by syntaxMORG0 and Samuraien2\n"
+        "You can find the Spark project at https://github.com/OpenSBCs/Spark\n"
+    );
+    return 0;
+}
+SHELL_COMMAND(about, sh_about, SH_SYSTEM, "", "Show info about Spark");
+
+static int sh_exit(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return SH_EXIT;
+}
+SHELL_COMMAND(exit, sh_exit, SH_SYSTEM, "", "Shutdown Spark");
+
+static int sh_clear(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    writeOut("\033[2J\033[H");  // ANSI escape codes: clear screen and move cursor to home
+    return 0;
+}
+SHELL_COMMAND(clear, sh_clear, SH_SYSTEM, "", "Clear the screen");
 
+static int sh_ls(int argc, char **argv) {
+    fat32_list_dir(argc > 1 ? argv[1] : "/");
     return 0;
 }
+SHELL_COMMAND(ls, sh_ls, SH_FILES | SH_NEEDS_FS, "[path]", "List directory contents");
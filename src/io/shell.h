@@ -1,7 +1,51 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+/*
+ * Shell
+ *
+ * Commands register themselves with SHELL_COMMAND() next to the code they
+ * run. Each registration is a descriptor in the .shell_commands section,
+ * which linker.ld gathers between __shell_commands_start and
+ * __shell_commands_end. The shell hashes the names once, so finding a
+ * command costs the same however many there are, and `help` is built from
+ * the same descriptors.
+ */
+
+#include <package.h>
+
+#define SH_MAX_ARGS         8
+#define SH_LINE_MAX         128
+#define SH_EXIT             66      // Returned by `exit` to leave the shell
+#define SH_MAX_COMMANDS     32      // linker.ld fails the link past this
+
+// Help groups, in the order `help` lists them
+#define SH_SYSTEM           0
+#define SH_FILES            1
+#define SH_DISK             2
+#define SH_GROUPS           3
+
+// Flags, or'ed into the group
+#define SH_GROUP_MASK       0x0F
+#define SH_NEEDS_FS         0x10    // Refuse to run without a mounted volume
+
+// argv[0] is the command name; argv[argc] is 0
+typedef int (*sh_main_t)(int argc, char **argv);
+
+typedef struct {
+    const char *name;
+    sh_main_t main;
+    u32 flags;                      // SH_SYSTEM/SH_FILES/SH_DISK | SH_NEEDS_FS
+    const char *usage;              // Arguments, for help
+    const char *help;
+} sh_command_t;
+
+#define SHELL_COMMAND(name, fn, flags, usage, help)                         \
+    static const sh_command_t sh_command_##name                             \
+    __attribute__((used, section(".shell_commands"), aligned(4))) =         \
+        { #name, fn, flags, usage, help }
+
 void sh_start(void);
 int sh_exec(const char *command);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,178 @@
+/*
+ * PL011 UART0 console with interrupt-driven TX/RX rings
+ */
+
+#include "uart.h"
+#include "input.h"
+#include <sys/irq.h>
+#include <sys/coroutine.h>
+
+static char tx_ring[UART_TX_RING_SIZE];
+static char rx_ring[UART_RX_RING_SIZE];
+
+// Free-running indices; head is written by the producer, tail by the consumer
+static volatile u32 tx_head = 0;
+static volatile u32 tx_tail = 0;
+static volatile u32 rx_head = 0;
+static volatile u32 rx_tail = 0;
+
+static volatile u32 rx_dropped = 0;
+static int uart_irq_enabled = 0;
+
+// ============================================================================
+// Ring Transfer (IRQ context, or IRQs disabled)
+// ============================================================================
+
+// Move queued bytes into the TX FIFO until it fills or the ring empties
+// The TX interrupt stays unmasked only while there is something left to send.
+static void uart_tx_fill(void) {
+    u32 tail = tx_tail;
+    while (tail != tx_head && !(*UART0_FR & UART0_FR_TXFF)) {
+        *UART0_DR = (unsigned int)(unsigned char)tx_ring[tail & (UART_TX_RING_SIZE - 1)];
+        tail++;
+    }
+    tx_tail = tail;
+
+    if (!uart_irq_enabled) return;
+    if (tail != tx_head) {
+        *UART0_IMSC |= UART0_INT_TX;
+    } else {
+        *UART0_IMSC &= ~UART0_INT_TX;
+    }
+}
+
+// Move received bytes from the RX FIFO into the ring
+static void uart_rx_drain(void) {
+    u32 head = rx_head;
+    while (!(*UART0_FR & UART0_FR_RXFE)) {
+        char c = (char)(*UART0_DR & 0xFF);
+        if (head - rx_tail < UART_RX_RING_SIZE) {
+            rx_ring[head & (UART_RX_RING_SIZE - 1)] = c;
+            head++;
+        } else {
+            rx_dropped++;
+        }
+    }
+    rx_head = head;
+}
+
+static void uart_irq(void) {
+    u32 mis = *UART0_MIS;
+    *UART0_ICR = mis;
+
+    if (mis & (UART0_INT_RX | UART0_INT_RT | UART0_INT_OE)) {
+        uart_rx_drain();
+        input_wake();
+    }
+    if (mis & UART0_INT_TX) {
+        uart_tx_fill();
+    }
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+void uart_init(void) {
+    *UART0_IMSC = 0;
+    *UART0_ICR = 0x7FF;
+    *UART0_IFLS = 0;    // TX at 1/8 empty, RX at 1/8 full
+
+    uart_irq_enabled = 1;
+    irq_register(IRQ_UART0, uart_irq);
+
+    *UART0_IMSC = UART0_INT_RX | UART0_INT_RT | UART0_INT_OE;
+
+    // Send anything queued before the interrupt was available
+    u32 flags = irq_save();
+    uart_tx_fill();
+    irq_restore(flags);
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+// Copy a span into the ring in at most two pieces per pass, then start the
+// transmitter once instead of once per byte
+void uart_write(const char *s, size_t n) {
+    while (n > 0) {
+        u32 head = tx_head;
+        u32 space = UART_TX_RING_SIZE - (head - tx_tail);
+
+        // Ring full: push bytes out by hand until there is room
+        if (space == 0) {
+            u32 flags = irq_save();
+            uart_tx_fill();
+            irq_restore(flags);
+            continue;
+        }
+
+        u32 offset = head & (UART_TX_RING_SIZE - 1);
+        u32 chunk = UART_TX_RING_SIZE - offset;     // Up to the wrap point
+        if (chunk > space) chunk = space;
+        if (chunk > n) chunk = n;
+
+        memcpy(&tx_ring[offset], s, chunk);
+        tx_head = head + chunk;
+        s += chunk;
+        n -= chunk;
+    }
+
+    // Start the transmitter if the interrupt is not already draining the ring
+    if (!uart_irq_enabled || !(*UART0_IMSC & UART0_INT_TX)) {
+        u32 flags = irq_save();
+        uart_tx_fill();
+        irq_restore(flags);
+    }
+}
+
+void uart_putchar(char c) {
+    uart_write(&c, 1);
+}
+
+void uart_flush(void) {
+    while (tx_head != tx_tail) {
+        u32 flags = irq_save();
+        uart_tx_fill();
+        irq_restore(flags);
+    }
+    while (*UART0_FR & UART0_FR_BUSY);
+}
+
+// ============================================================================
+// Input
+// ============================================================================
+
+int uart_has_data(void) {
+    if (rx_head != rx_tail) return 1;
+
+    // Without the interrupt (or before it fires) pick up bytes directly
+    u32 flags = irq_save();
+    uart_rx_drain();
+    irq_restore(flags);
+
+    return rx_head != rx_tail;
+}
+
+int uart_read(void) {
+    if (!uart_has_data()) return -1;
+
+    char c = rx_ring[rx_tail & (UART_RX_RING_SIZE - 1)];
+    rx_tail++;
+    return (unsigned char)c;
+}
+
+static int uart_rx_ready(void *arg) {
+    (void)arg;
+    return uart_has_data();
+}
+
+char uart_getchar(void) {
+    co_await_io(uart_rx_ready, 0);
+    return (char)uart_read();
+}
+
+u32 uart_rx_dropped(void) {
+    return rx_dropped;
+}
@@ -1,22 +1,65 @@
 #ifndef UART_H
 #define UART_H
 
+/*
+ * PL011 UART0 console
+ *
+ * Output is queued in a TX ring and drained by the transmit interrupt, so
+ * writers return as soon as their bytes are buffered. The receive
+ * interrupt moves incoming bytes into an RX ring, which keeps pasted input
+ * from overflowing the 16-byte hardware FIFO while the CPU is busy.
+ *
+ * Each ring has one producer and one consumer (the console writer or
+ * reader on one side, the IRQ handler on the other) and needs no lock.
+ * Before uart_init() the rings are drained and filled by polling.
+ */
+
+#include <package.h>
+
 #define UART0_BASE    0x101F1000
 #define UART0_DR      ((volatile unsigned int*)(UART0_BASE + 0x00))
 #define UART0_FR      ((volatile unsigned int*)(UART0_BASE + 0x18))
+#define UART0_IFLS    ((volatile unsigned int*)(UART0_BASE + 0x34))
+#define UART0_IMSC    ((volatile unsigned int*)(UART0_BASE + 0x38))
+#define UART0_MIS     ((volatile unsigned int*)(UART0_BASE + 0x40))
+#define UART0_ICR     ((volatile unsigned int*)(UART0_BASE + 0x44))
+
+#define UART0_FR_BUSY (1 << 3)  /* Still transmitting */
 #define UART0_FR_TXFF (1 << 5)  /* Transmit FIFO full */
 #define UART0_FR_RXFE (1 << 4)  /* Receive FIFO empty */
 
+/* Interrupt mask / status bits */
+#define UART0_INT_RX  (1 << 4)  /* RX FIFO at trigger level */
+#define UART0_INT_TX  (1 << 5)  /* TX FIFO at trigger level */
+#define UART0_INT_RT  (1 << 6)  /* RX timeout (data sitting in FIFO) */
+#define UART0_INT_OE  (1 << 10) /* RX overrun */
+
+/* Ring sizes (powers of two, see config/config.h) */
+#define UART_TX_RING_SIZE   CONFIG_UART_TX_SIZE
+#define UART_RX_RING_SIZE   CONFIG_UART_RX_SIZE
+
+/* Switch to interrupt-driven operation */
+void uart_init(void);
+
+/* Queue a character for output (waits only while the TX ring is full) */
+void uart_putchar(char c);
+
+/* Queue n bytes for output */
+void uart_write(const char *s, size_t n);
+
+/* Wait until every queued byte has left the UART */
+void uart_flush(void);
+
+/* Non-zero if a received byte is waiting */
+int uart_has_data(void);
+
+/* Next received byte, or -1 if none */
+int uart_read(void);
+
 /* Read a character from UART (blocking) */
-static inline char uart_getchar(void) {
-    while (*UART0_FR & UART0_FR_RXFE);  /* Wait for data */
-    return (char)(*UART0_DR & 0xFF);
-}
-
-/* Write a character to UART (blocking) */
-static inline void uart_putchar(char c) {
-    while (*UART0_FR & UART0_FR_TXFF);  /* Wait for space */
-    *UART0_DR = (unsigned int)c;
-}
-
-#endif
\ No newline at end of file
+char uart_getchar(void);
+
+/* Bytes dropped because the RX ring was full */
+u32 uart_rx_dropped(void);
+
+#endif
@@ -1,13 +1,51 @@
 #include "package.h"
 #include "io/shell.h"
-// Preload menu (defined in src/Prel.c)
-void SelectParition(void);
+#include "drivers/pl181_sd.h"
+#include "io/uart.h"
+#include "io/input.h"
+#include "sys/irq.h"
+#include "sys/thread.h"
+#include "sys/hud.h"
+#include "sys/bootcfg.h"
+#include "sys/bootinfo.h"
+#include "sys/heap.h"
+#include "drivers/fat32Driver.h"
 
-void kernel_main(void) {
-    initGraphics();
-    SelectParition();
+// First byte after the kernel image (linker.ld)
+extern char _end[];
+
+// r0-r2 as the bootloader left them (boot.s)
+void kernel_main(u32 r0, u32 machine, u32 atags) {
+    (void)r0;
+    (void)machine;
+
+    // Memory size and options first: the ATAG list sits in low RAM that
+    // nothing protects
+    bootinfo_parse(atags);
+    heap_init((u32)_end, boot_ram_start() + boot_ram_size());
+    u32 cache = CONFIG_FAT_CACHE_SECTORS;
+#if CONFIG_FAT_CACHE_SCALE
+    if (boot_ram_size() / FAT32_CACHE_RAM_PER_SECTOR > cache) {
+        cache = boot_ram_size() / FAT32_CACHE_RAM_PER_SECTOR;
+    }
+#endif
+    fat32_cache_init(boot_option_u32("cache", cache));
+
+    // Interrupts and scheduler; kernel_main continues as the "main" thread
+    irq_init();
+    uart_init();
+    input_init();
+    thread_init();
+
+    // Start powering up the SD card; it finishes while the screen comes up
+    sd_init_start();
+    if (initGraphics() == 0) {
+        hud_start();
+    }
+    bootcfg_load();
 
     writeOut("Hello from spark!\n\n");
+    bootcfg_autostart();
 
     sh_start();
 
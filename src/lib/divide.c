@@ -0,0 +1,86 @@
+/*
+ * Integer division runtime for the ARM926EJ-S
+ *
+ * The core has no divide instruction, so GCC lowers every '/' and '%' by
+ * a variable to the EABI helpers below. Division by a constant never gets
+ * here: GCC turns it into a multiply by the reciprocal or a shift.
+ *
+ * The divider lines the divisor up with the dividend using CLZ and only
+ * runs as many shift-subtract steps as the quotient has bits, so the
+ * common small quotients (cluster and sector arithmetic) finish in a few
+ * iterations. Power-of-two divisors are a plain shift.
+ */
+
+#include <package.h>
+
+// EABI divide by zero hook; the quotient is whatever it returns
+int __aeabi_idiv0(int result) {
+    return result;
+}
+
+// Unsigned divide with remainder
+static inline u32 udivmod(u32 n, u32 d, u32 *rem) {
+    if (d == 0) {
+        *rem = n;
+        return __aeabi_idiv0(0);
+    }
+
+    if (n < d) {
+        *rem = n;
+        return 0;
+    }
+
+    // Power of two: shift and mask
+    if ((d & (d - 1)) == 0) {
+        *rem = n & (d - 1);
+        return n >> (31 - __builtin_clz(d));
+    }
+
+    // Align the divisor's top bit with the dividend's, then one step per quotient bit
+    int shift = __builtin_clz(d) - __builtin_clz(n);
+    u32 q = 0;
+    d <<= shift;
+
+    for (int i = 0; i <= shift; i++) {
+        q <<= 1;
+        if (n >= d) {
+            n -= d;
+            q |= 1;
+        }
+        d >>= 1;
+    }
+
+    *rem = n;
+    return q;
+}
+
+// ============================================================================
+// EABI Entry Points
+// ============================================================================
+
+u32 __aeabi_uidiv(u32 n, u32 d) {
+    u32 rem;
+    return udivmod(n, d, &rem);
+}
+
+// Quotient in r0, remainder in r1 (returned as the two halves of a u64)
+u64 __aeabi_uidivmod(u32 n, u32 d) {
+    u32 rem;
+    u32 q = udivmod(n, d, &rem);
+    return ((u64)rem << 32) | q;
+}
+
+i32 __aeabi_idiv(i32 n, i32 d) {
+    u32 rem;
+    u32 q = udivmod(n < 0 ? -(u32)n : (u32)n, d < 0 ? -(u32)d : (u32)d, &rem);
+    return ((n ^ d) < 0) ? -(i32)q : (i32)q;
+}
+
+// Quotient in r0, remainder in r1; the remainder takes the dividend's sign
+u64 __aeabi_idivmod(i32 n, i32 d) {
+    u32 rem;
+    u32 q = udivmod(n < 0 ? -(u32)n : (u32)n, d < 0 ? -(u32)d : (u32)d, &rem);
+    if ((n ^ d) < 0) q = -q;
+    if (n < 0) rem = -rem;
+    return ((u64)rem << 32) | q;
+}
@@ -0,0 +1,230 @@
+/*
+ * printf-style formatting engine
+ *
+ * Decimal conversion emits two digits per step from a 200-byte pair
+ * table. The divide by 100 is by a constant, so GCC turns it into a
+ * multiply; a ten-digit number costs five of those instead of ten trips
+ * through the division runtime.
+ */
+
+#include <package.h>
+#include "format.h"
+
+static const char fmt_digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char fmt_hex_lower[] = "0123456789abcdef";
+static const char fmt_hex_upper[] = "0123456789ABCDEF";
+
+static const char fmt_spaces[] = "                ";
+static const char fmt_zeros[]  = "0000000000000000";
+
+// ============================================================================
+// Number Conversion
+// ============================================================================
+
+char *fmt_u32(char *end, unsigned long v) {
+    char *p = end;
+
+    while (v >= 100) {
+        unsigned long q = v / 100;
+        unsigned r = (unsigned)(v - q * 100);
+        p -= 2;
+        p[0] = fmt_digit_pairs[r * 2];
+        p[1] = fmt_digit_pairs[r * 2 + 1];
+        v = q;
+    }
+
+    if (v >= 10) {
+        p -= 2;
+        p[0] = fmt_digit_pairs[v * 2];
+        p[1] = fmt_digit_pairs[v * 2 + 1];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+// Hex digits of v ending just before end
+static char *fmt_hex(char *end, unsigned long v, const char *digits) {
+    char *p = end;
+    do {
+        *--p = digits[v & 0xF];
+        v >>= 4;
+    } while (v);
+    return p;
+}
+
+// ============================================================================
+// Engine
+// ============================================================================
+
+// Emit count copies of a padding character in chunks
+static void fmt_pad(fmt_sink_t sink, void *ctx, char pad, int count) {
+    const char *src = (pad == '0') ? fmt_zeros : fmt_spaces;
+    while (count > 0) {
+        int chunk = count < 16 ? count : 16;
+        sink(ctx, src, chunk);
+        count -= chunk;
+    }
+}
+
+// Emit a converted field with its padding; returns characters produced
+static int fmt_field(fmt_sink_t sink, void *ctx, const char *s, int len,
+                     int width, int left, char pad) {
+    int total = len > width ? len : width;
+
+    // Zero padding goes after the sign
+    if (pad == '0' && len > 0 && s[0] == '-') {
+        sink(ctx, s, 1);
+        s++;
+        len--;
+        width--;
+    }
+    if (!left && width > len) fmt_pad(sink, ctx, pad, width - len);
+    if (len > 0) sink(ctx, s, len);
+    if (left && width > len) fmt_pad(sink, ctx, ' ', width - len);
+
+    return total;
+}
+
+int kvformat(fmt_sink_t sink, void *ctx, const char *fmt, va_list ap) {
+    char num[24];
+    char *end = num + sizeof(num);
+    int count = 0;
+
+    while (*fmt) {
+        // Literal text up to the next conversion goes out as one span
+        const char *run = fmt;
+        while (*fmt && *fmt != '%') fmt++;
+        if (fmt > run) {
+            sink(ctx, run, fmt - run);
+            count += fmt - run;
+        }
+        if (!*fmt) break;
+        fmt++;
+
+        int left = 0;
+        char pad = ' ';
+        while (*fmt == '-' || *fmt == '0') {
+            if (*fmt == '-') left = 1; else pad = '0';
+            fmt++;
+        }
+        if (left) pad = ' ';
+
+        int width = 0;
+        while (*fmt >= '0' && *fmt <= '9') {
+            width = width * 10 + (*fmt++ - '0');
+        }
+
+        int is_long = 0;
+        while (*fmt == 'l') {
+            is_long = 1;
+            fmt++;
+        }
+
+        char conv = *fmt;
+        if (conv == '\0') break;
+        fmt++;
+
+        char *p;
+        switch (conv) {
+            case 'd':
+            case 'i': {
+                long v = is_long ? va_arg(ap, long) : va_arg(ap, int);
+                p = fmt_u32(end, v < 0 ? -(unsigned long)v : (unsigned long)v);
+                if (v < 0) *--p = '-';
+                count += fmt_field(sink, ctx, p, end - p, width, left, pad);
+                break;
+            }
+            case 'u': {
+                unsigned long v = is_long ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+                p = fmt_u32(end, v);
+                count += fmt_field(sink, ctx, p, end - p, width, left, pad);
+                break;
+            }
+            case 'x':
+            case 'X': {
+                unsigned long v = is_long ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+                p = fmt_hex(end, v, conv == 'X' ? fmt_hex_upper : fmt_hex_lower);
+                count += fmt_field(sink, ctx, p, end - p, width, left, pad);
+                break;
+            }
+            case 'p': {
+                p = fmt_hex(end, (unsigned long)va_arg(ap, void *), fmt_hex_lower);
+                *--p = 'x';
+                *--p = '0';
+                count += fmt_field(sink, ctx, p, end - p, width, left, ' ');
+                break;
+            }
+            case 'c':
+                num[0] = (char)va_arg(ap, int);
+                count += fmt_field(sink, ctx, num, 1, width, left, ' ');
+                break;
+            case 's': {
+                const char *s = va_arg(ap, const char *);
+                if (!s) s = "(null)";
+                count += fmt_field(sink, ctx, s, strlen(s), width, left, ' ');
+                break;
+            }
+            case '%':
+                sink(ctx, "%", 1);
+                count++;
+                break;
+            default:
+                // Unknown conversion: show it as written
+                num[0] = '%';
+                num[1] = conv;
+                sink(ctx, num, 2);
+                count += 2;
+                break;
+        }
+    }
+
+    return count;
+}
+
+// ============================================================================
+// Buffer Sink
+// ============================================================================
+
+typedef struct {
+    char *buf;
+    size_t size;        // Room for characters (excluding the NUL)
+    size_t len;
+} fmt_buf_t;
+
+static void fmt_buf_sink(void *ctx, const char *s, size_t n) {
+    fmt_buf_t *b = (fmt_buf_t *)ctx;
+    if (b->len < b->size) {
+        size_t room = b->size - b->len;
+        memcpy(b->buf + b->len, s, n < room ? n : room);
+    }
+    b->len += n;
+}
+
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap) {
+    fmt_buf_t b = { buf, size ? size - 1 : 0, 0 };
+    int n = kvformat(fmt_buf_sink, &b, fmt, ap);
+    if (size) {
+        buf[b.len < b.size ? b.len : b.size] = '\0';
+    }
+    return n;
+}
+
+int ksnprintf(char *buf, size_t size, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = kvsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
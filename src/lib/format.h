@@ -0,0 +1,33 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/*
+ * printf-style formatting engine
+ *
+ * kvformat() walks the format string once and hands the output to a sink
+ * in spans: each literal run, converted field and padding block is one
+ * call. The console (kprintf), the kernel log (klog) and fixed buffers
+ * (ksnprintf) are all sinks on top of it. Nothing is allocated.
+ *
+ * Conversions: %d %i %u %x %X %p %c %s %%
+ * Flags: '-' (left align), '0' (zero pad), field width, 'l' (long)
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+
+typedef void (*fmt_sink_t)(void *ctx, const char *s, size_t n);
+
+// Format to a sink; returns the number of characters produced
+int kvformat(fmt_sink_t sink, void *ctx, const char *fmt, va_list ap);
+
+// Format into buf (always NUL terminated when size > 0)
+// Returns the length the full output would have had, like snprintf
+int kvsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+int ksnprintf(char *buf, size_t size, const char *fmt, ...);
+
+// Write the decimal digits of v so they end just before end
+// Returns a pointer to the first digit (end - 10 must be valid memory)
+char *fmt_u32(char *end, unsigned long v);
+
+#endif
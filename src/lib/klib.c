@@ -0,0 +1,280 @@
+/*
+ * Freestanding memory and string routines for the ARM926EJ-S
+ *
+ * Bulk copies move 32 bytes per loop iteration with LDM/STM, which keeps
+ * the write buffer doing full bursts instead of single-byte stores. Heads
+ * and tails that are not word aligned are handled a byte at a time.
+ *
+ * This file is built with -fno-tree-loop-distribute-patterns (see the
+ * Makefile) so GCC does not turn the byte loops back into memcpy calls.
+ */
+
+#define KLIB_IMPL
+#include <package.h>
+
+// Below this size the alignment work costs more than it saves
+#define KLIB_BULK_MIN   16
+
+// Word with every byte set to c
+#define KLIB_SPLAT(c)   (((u32)(c) & 0xFF) * 0x01010101u)
+
+// True if any byte of w is zero
+#define KLIB_HAS_ZERO(w) (((w) - 0x01010101u) & ~(w) & 0x80808080u)
+
+// ============================================================================
+// Block Helpers
+// ============================================================================
+
+// Copy blocks of 32 bytes forwards (both pointers word aligned, blocks > 0)
+static inline void klib_copy_blocks(u8 **dp, const u8 **sp, u32 blocks) {
+    u8 *d = *dp;
+    const u8 *s = *sp;
+
+    __asm__ volatile(
+        "1:\n\t"
+        "pld    [%1, #64]\n\t"
+        "ldmia  %1!, {r3, r4, r5, ip}\n\t"
+        "stmia  %0!, {r3, r4, r5, ip}\n\t"
+        "ldmia  %1!, {r3, r4, r5, ip}\n\t"
+        "stmia  %0!, {r3, r4, r5, ip}\n\t"
+        "subs   %2, %2, #1\n\t"
+        "bne    1b"
+        : "+r"(d), "+r"(s), "+r"(blocks)
+        :
+        : "r3", "r4", "r5", "ip", "cc", "memory");
+
+    *dp = d;
+    *sp = s;
+}
+
+// Copy blocks of 32 bytes backwards, pointers at the end of each buffer
+static inline void klib_copy_blocks_back(u8 **dp, const u8 **sp, u32 blocks) {
+    u8 *d = *dp;
+    const u8 *s = *sp;
+
+    __asm__ volatile(
+        "1:\n\t"
+        "pld    [%1, #-64]\n\t"
+        "ldmdb  %1!, {r3, r4, r5, ip}\n\t"
+        "stmdb  %0!, {r3, r4, r5, ip}\n\t"
+        "ldmdb  %1!, {r3, r4, r5, ip}\n\t"
+        "stmdb  %0!, {r3, r4, r5, ip}\n\t"
+        "subs   %2, %2, #1\n\t"
+        "bne    1b"
+        : "+r"(d), "+r"(s), "+r"(blocks)
+        :
+        : "r3", "r4", "r5", "ip", "cc", "memory");
+
+    *dp = d;
+    *sp = s;
+}
+
+// Fill blocks of 32 bytes with a word pattern (pointer word aligned)
+static inline void klib_fill_blocks(u8 **dp, u32 word, u32 blocks) {
+    u8 *d = *dp;
+
+    __asm__ volatile(
+        "mov    r3, %2\n\t"
+        "mov    r4, %2\n\t"
+        "mov    r5, %2\n\t"
+        "mov    ip, %2\n\t"
+        "1:\n\t"
+        "stmia  %0!, {r3, r4, r5, ip}\n\t"
+        "stmia  %0!, {r3, r4, r5, ip}\n\t"
+        "subs   %1, %1, #1\n\t"
+        "bne    1b"
+        : "+r"(d), "+r"(blocks)
+        : "r"(word)
+        : "r3", "r4", "r5", "ip", "cc", "memory");
+
+    *dp = d;
+}
+
+// ============================================================================
+// Memory Functions
+// ============================================================================
+
+void *memcpy(void *dest, const void *src, size_t n) {
+    u8 *d = (u8 *)dest;
+    const u8 *s = (const u8 *)src;
+
+    // Word transfers need both pointers to share the same alignment
+    if (n >= KLIB_BULK_MIN && (((u32)d ^ (u32)s) & 3) == 0) {
+        while ((u32)d & 3) {
+            *d++ = *s++;
+            n--;
+        }
+
+        if (n >= 32) {
+            klib_copy_blocks(&d, &s, n >> 5);
+            n &= 31;
+        }
+
+        while (n >= 4) {
+            *(u32 *)d = *(const u32 *)s;
+            d += 4;
+            s += 4;
+            n -= 4;
+        }
+    }
+
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t n) {
+    u8 *d = (u8 *)dest;
+    const u8 *s = (const u8 *)src;
+
+    // A forward copy is safe unless dest starts inside src
+    if (d <= s || d >= s + n) {
+        return memcpy(dest, src, n);
+    }
+
+    // Overlapping with dest above src: copy from the end
+    d += n;
+    s += n;
+
+    if (n >= KLIB_BULK_MIN && (((u32)d ^ (u32)s) & 3) == 0) {
+        while ((u32)d & 3) {
+            *--d = *--s;
+            n--;
+        }
+
+        if (n >= 32) {
+            klib_copy_blocks_back(&d, &s, n >> 5);
+            n &= 31;
+        }
+
+        while (n >= 4) {
+            d -= 4;
+            s -= 4;
+            *(u32 *)d = *(const u32 *)s;
+            n -= 4;
+        }
+    }
+
+    while (n--) {
+        *--d = *--s;
+    }
+    return dest;
+}
+
+void *memset(void *s, int c, size_t n) {
+    u8 *d = (u8 *)s;
+
+    if (n >= KLIB_BULK_MIN) {
+        u32 word = KLIB_SPLAT(c);
+
+        while ((u32)d & 3) {
+            *d++ = (u8)c;
+            n--;
+        }
+
+        if (n >= 32) {
+            klib_fill_blocks(&d, word, n >> 5);
+            n &= 31;
+        }
+
+        while (n >= 4) {
+            *(u32 *)d = word;
+            d += 4;
+            n -= 4;
+        }
+    }
+
+    while (n--) {
+        *d++ = (u8)c;
+    }
+    return s;
+}
+
+int memcmp(const void *s1, const void *s2, size_t n) {
+    const u8 *p1 = (const u8 *)s1;
+    const u8 *p2 = (const u8 *)s2;
+
+    // Skip equal words quickly; the differing word is resolved bytewise
+    if (n >= KLIB_BULK_MIN && (((u32)p1 ^ (u32)p2) & 3) == 0) {
+        while ((u32)p1 & 3) {
+            if (*p1 != *p2) return *p1 - *p2;
+            p1++;
+            p2++;
+            n--;
+        }
+
+        while (n >= 4 && *(const u32 *)p1 == *(const u32 *)p2) {
+            p1 += 4;
+            p2 += 4;
+            n -= 4;
+        }
+    }
+
+    while (n--) {
+        if (*p1 != *p2) return *p1 - *p2;
+        p1++;
+        p2++;
+    }
+    return 0;
+}
+
+// ============================================================================
+// String Functions
+// ============================================================================
+
+size_t strlen(const char *s) {
+    const char *p = s;
+
+    // Walk to a word boundary, then test four bytes at a time
+    while ((u32)p & 3) {
+        if (*p == '\0') return p - s;
+        p++;
+    }
+
+    const u32 *w = (const u32 *)p;
+    while (!KLIB_HAS_ZERO(*w)) {
+        w++;
+    }
+
+    p = (const char *)w;
+    while (*p) {
+        p++;
+    }
+    return p - s;
+}
+
+// strcpy - copy string from src to dest
+char *strcpy(char *dest, const char *src) {
+    char *original = dest;
+    while ((*dest++ = *src++));
+    return original;
+}
+
+// strcmp - compare two strings
+int strcmp(const char *s1, const char *s2) {
+    while (*s1 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+    }
+    return *(unsigned char *)s1 - *(unsigned char *)s2;
+}
+
+// strncmp - compare first n characters of two strings
+int strncmp(const char *s1, const char *s2, size_t n) {
+    while (n > 0 && *s1 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+        n--;
+    }
+    if (n == 0) return 0;
+    return *(unsigned char *)s1 - *(unsigned char *)s2;
+}
+
+// startsWith - check if string starts with prefix
+int startsWith(const char *str, const char *prefix) {
+    while (*prefix) {
+        if (*str++ != *prefix++) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,36 @@
+#ifndef KLIB_H
+#define KLIB_H
+
+/*
+ * Freestanding memory and string routines
+ *
+ * These are the only copies of memcpy/memset/strlen and friends in the
+ * kernel. GCC also emits calls to memcpy/memset/memmove/memcmp for struct
+ * copies and for loops it recognises, so the names must stay standard.
+ */
+
+#include <stddef.h>
+
+void *memcpy(void *dest, const void *src, size_t n);
+void *memmove(void *dest, const void *src, size_t n);
+void *memset(void *s, int c, size_t n);
+int memcmp(const void *s1, const void *s2, size_t n);
+
+size_t strlen(const char *s);
+char *strcpy(char *dest, const char *src);
+int strcmp(const char *s1, const char *s2);
+int strncmp(const char *s1, const char *s2, size_t n);
+int startsWith(const char *str, const char *prefix);
+
+// -ffreestanding turns off the builtins; route calls through them again so
+// small fixed-size copies and compares are expanded inline and the rest
+// end up in the functions above.
+#ifndef KLIB_IMPL
+#define memcpy(d, s, n)     __builtin_memcpy((d), (s), (n))
+#define memmove(d, s, n)    __builtin_memmove((d), (s), (n))
+#define memset(s, c, n)     __builtin_memset((s), (c), (n))
+#define memcmp(a, b, n)     __builtin_memcmp((a), (b), (n))
+#define strlen(s)           __builtin_strlen((s))
+#endif
+
+#endif
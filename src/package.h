@@ -11,14 +11,15 @@ typedef int i32;
 typedef long long i64;
 
 #include <stddef.h>
+#include <config/config.h>
+#include <lib/klib.h>
+#include <lib/format.h>
 
-char *strcpy(char *dest, const char *src);
-void initGraphics(void);
+int initGraphics(void);
 void writeOut(const char *s);
+void writeOutN(const char *s, size_t n);
 void writeOutNum(long num);
-int strcmp(const char *s1, const char *s2);
-int strncmp(const char *s1, const char *s2, size_t n);
-int startsWith(const char *str, const char *prefix);
+int kprintf(const char *fmt, ...);
 void exit(void);
 int readline(char *buf, size_t bufSize);
 
@@ -6,6 +6,7 @@
 
 #include <package.h>
 #include <drivers/fat32Driver.h>
+#include <io/shell.h>
 
 int prog_cat(const char *path) {
     if (!path || path[0] == '\0') {
@@ -34,8 +35,7 @@ int prog_cat(const char *path) {
     int bytes = fat32_read_file(path, file_buffer, sizeof(file_buffer) - 1);
 
     if (bytes >= 0) {
-        file_buffer[bytes] = '\0';
-        writeOut(file_buffer);
+        writeOutN(file_buffer, bytes);
         writeOut("\n");
         return 0;
     } else {
@@ -43,3 +43,8 @@ int prog_cat(const char *path) {
         return 1;
     }
 }
+
+static int cat_main(int argc, char **argv) {
+    return prog_cat(argc > 1 ? argv[1] : 0);
+}
+SHELL_COMMAND(cat, cat_main, SH_FILES | SH_NEEDS_FS, "<file>", "Display file contents");
@@ -8,6 +8,7 @@
 
 #include <package.h>
 #include <drivers/fat32Driver.h>
+#include <io/shell.h>
 
 int prog_cp(const char *src, const char *dst) {
     if (!src || src[0] == '\0') {
@@ -55,3 +56,8 @@ int prog_cp(const char *src, const char *dst) {
     writeOut("Error: cp not yet implemented (filesystem write support needed)\n");
     return 1;
 }
+
+static int cp_main(int argc, char **argv) {
+    return prog_cp(argc > 1 ? argv[1] : 0, argc > 2 ? argv[2] : 0);
+}
+SHELL_COMMAND(cp, cp_main, SH_FILES | SH_NEEDS_FS, "<src> <dst>", "Copy a file");
@@ -0,0 +1,26 @@
+/*
+ * dmesg - Print the kernel log
+ *
+ * Usage: dmesg
+ */
+
+#include <package.h>
+#include <sys/klog.h>
+#include <io/shell.h>
+
+static void dmesg_sink(void *ctx, const char *s, size_t n) {
+    (void)ctx;
+    writeOutN(s, n);
+}
+
+int prog_dmesg(void) {
+    klog_dump(dmesg_sink, 0);
+    return 0;
+}
+
+static int dmesg_main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return prog_dmesg();
+}
+SHELL_COMMAND(dmesg, dmesg_main, SH_SYSTEM, "", "Show the kernel log");
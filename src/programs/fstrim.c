@@ -0,0 +1,59 @@
+/*
+ * fstrim - Discard unused blocks on the mounted filesystem
+ *
+ * Usage: fstrim
+ *        discard [on|off]
+ */
+
+#include <package.h>
+#include <drivers/writeDriver.h>
+#include <io/shell.h>
+
+int prog_fstrim(void) {
+    if (!fat32_is_initialized()) {
+        writeOut("Error: Filesystem not mounted. Run 'setup' then 'part'.\n");
+        return 1;
+    }
+
+    int trimmed = fat32_trim_free();
+    if (trimmed < 0) {
+        writeOut("Error: Discard failed\n");
+        return 1;
+    }
+
+    writeOut("Trimmed ");
+    writeOutNum(trimmed);
+    writeOut(" clusters (");
+    writeOutNum(trimmed * (g_fat32_fs.bytes_per_cluster >> 10));
+    writeOut(" KB)\n");
+    return 0;
+}
+
+int prog_discard(const char *arg) {
+    if (arg) {
+        if (strcmp(arg, "on") == 0) {
+            fat32_set_discard(1);
+        } else if (strcmp(arg, "off") == 0) {
+            fat32_set_discard(0);
+        } else {
+            writeOut("Usage: discard [on|off]\n");
+            return 1;
+        }
+    }
+
+    writeOut("Online discard: ");
+    writeOut(g_fat32_fs.discard ? "on\n" : "off\n");
+    return 0;
+}
+
+static int fstrim_main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return prog_fstrim();
+}
+SHELL_COMMAND(fstrim, fstrim_main, SH_DISK, "", "Discard all free clusters on the card");
+
+static int discard_main(int argc, char **argv) {
+    return prog_discard(argc > 1 ? argv[1] : 0);
+}
+SHELL_COMMAND(discard, discard_main, SH_DISK, "[on|off]", "Discard clusters as files are freed");
@@ -8,6 +8,7 @@
 
 #include <package.h>
 #include <drivers/fat32Driver.h>
+#include <io/shell.h>
 
 int prog_mv(const char *src, const char *dst) {
     if (!src || src[0] == '\0') {
@@ -48,3 +49,8 @@ int prog_mv(const char *src, const char *dst) {
     writeOut("Error: mv not yet implemented (filesystem write support needed)\n");
     return 1;
 }
+
+static int mv_main(int argc, char **argv) {
+    return prog_mv(argc > 1 ? argv[1] : 0, argc > 2 ? argv[2] : 0);
+}
+SHELL_COMMAND(mv, mv_main, SH_FILES | SH_NEEDS_FS, "<src> <dst>", "Move or rename a file");
@@ -0,0 +1,56 @@
+/*
+ * ps - List kernel threads
+ *
+ * Usage: ps
+ */
+
+#include <package.h>
+#include <sys/thread.h>
+#include <sys/tick.h>
+#include <io/shell.h>
+
+static const char *ps_state_name(thread_state_t state) {
+    switch (state) {
+        case THREAD_READY:    return "ready   ";
+        case THREAD_RUNNING:  return "running ";
+        case THREAD_BLOCKED:  return "blocked ";
+        case THREAD_SLEEPING: return "sleeping";
+        case THREAD_ZOMBIE:   return "zombie  ";
+        default:              return "?       ";
+    }
+}
+
+// Share of `total` as a percentage, at most 100. Divides first only once
+// part * 100 would overflow (after about five days), when total / 100 is
+// large enough that the truncation does not show.
+static u32 ps_percent(u32 part, u32 total) {
+    u32 pct;
+    if (part <= 0xFFFFFFFFu / 100) {
+        pct = part * 100 / total;
+    } else {
+        pct = part / (total / 100);
+    }
+    return pct > 100 ? 100 : pct;
+}
+
+int prog_ps(void) {
+    u32 total = ticks;
+    if (total == 0) total = 1;
+
+    writeOut("  ID PRI STATE     CPU% NAME\n");
+    for (int i = 0; i < THREAD_MAX; i++) {
+        thread_t *t = thread_get(i);
+        if (!t) continue;
+
+        kprintf("%4u%4d %s%5u %s\n", t->id, t->priority,
+                ps_state_name(t->state), ps_percent(t->run_ticks, total), t->name);
+    }
+    return 0;
+}
+
+static int ps_main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return prog_ps();
+}
+SHELL_COMMAND(ps, ps_main, SH_SYSTEM, "", "List kernel threads");
@@ -8,6 +8,7 @@
 
 #include <package.h>
 #include <drivers/fat32Driver.h>
+#include <io/shell.h>
 
 int prog_rm(const char *path) {
     if (!path || path[0] == '\0') {
@@ -41,3 +42,8 @@ int prog_rm(const char *path) {
     writeOut("Error: rm not yet implemented (filesystem write support needed)\n");
     return 1;
 }
+
+static int rm_main(int argc, char **argv) {
+    return prog_rm(argc > 1 ? argv[1] : 0);
+}
+SHELL_COMMAND(rm, rm_main, SH_FILES | SH_NEEDS_FS, "<file>", "Remove a file");
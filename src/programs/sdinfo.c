@@ -0,0 +1,40 @@
+/*
+ * sdinfo - Show SD card and bus parameters
+ *
+ * Usage: sdinfo
+ */
+
+#include <package.h>
+#include <drivers/pl181_sd.h>
+#include <io/shell.h>
+
+int prog_sdinfo(void) {
+    if (sd_init() != 0) {
+        writeOut("Error: No SD card\n");
+        return 1;
+    }
+
+    writeOut("Card:      ");
+    writeOut(sd_is_high_capacity() ? "SDHC/SDXC\n" : "SDSC\n");
+    writeOut("Capacity:  ");
+    writeOutNum(sd_get_capacity() >> 11);
+    writeOut(" MB (");
+    writeOutNum(sd_get_capacity());
+    writeOut(" sectors)\n");
+    writeOut("Bus width: ");
+    writeOutNum(sd_get_bus_width());
+    writeOut(" bit\n");
+    writeOut("Clock:     ");
+    writeOutNum(sd_get_clock_hz());
+    writeOut(" Hz (card rated ");
+    writeOutNum(sd_get_max_clock_hz());
+    writeOut(" Hz)\n");
+    return 0;
+}
+
+static int sdinfo_main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return prog_sdinfo();
+}
+SHELL_COMMAND(sdinfo, sdinfo_main, SH_DISK, "", "Show SD card, bus width and clock");
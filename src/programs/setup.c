@@ -2,6 +2,9 @@
 #include "strings.h"
 #include <io/print.h>
 #include <drivers/fat32Driver.h>
+#include <io/shell.h>
+
+#if CONFIG_SETUP
 
 // Preload menu selector
 void SelectParition(void);
@@ -37,3 +40,14 @@ void prog_setup(void) {
 
     return;
 };
+
+static int setup_main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    prog_setup();
+    return 0;
+}
+SHELL_COMMAND(setup, setup_main, SH_SYSTEM, "", "Run setup wizard");
+SHELL_COMMAND(ssw, setup_main, SH_SYSTEM, "", "Same as setup");
+
+#endif // CONFIG_SETUP
@@ -6,6 +6,7 @@
 
 #include <package.h>
 #include <drivers/writeDriver.h>
+#include <io/shell.h>
 
 int prog_touch(const char *path) {
     if (!path || path[0] == '\0') {
@@ -48,3 +49,9 @@ int prog_touch(const char *path) {
         return 1;
     }
 }
+
+static int touch_main(int argc, char **argv) {
+    return prog_touch(argc > 1 ? argv[1] : 0);
+}
+SHELL_COMMAND(touch, touch_main, SH_FILES | SH_NEEDS_FS, "<file>", "Create empty file");
+SHELL_COMMAND(mkf, touch_main, SH_FILES | SH_NEEDS_FS, "<file>", "Same as touch");
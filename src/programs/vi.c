@@ -13,8 +13,10 @@
 #include <drivers/fat32Driver.h>
 #include <drivers/writeDriver.h>
 #include "io/print.h"
-#include "io/uart.h"
-#include <drivers/ps2Keyboard.h>
+#include "io/input.h"
+#include "io/shell.h"
+
+#if CONFIG_VI
 
 // ============================================================================
 // Configuration
@@ -52,72 +54,52 @@ typedef struct {
 static vi_state_t vi;
 
 // ============================================================================
-// Software Division (ARM has no hardware divider)
+// Utility Functions
 // ============================================================================
 
-static unsigned int vi_div(unsigned int n, unsigned int d) {
-    if (d == 0) return 0;
-    unsigned int q = 0;
-    unsigned int r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-            q |= (1U << i);
-        }
-    }
-    return q;
-}
-
-static unsigned int vi_mod(unsigned int n, unsigned int d) {
-    if (d == 0) return 0;
-    unsigned int r = 0;
-    for (int i = 31; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1);
-        if (r >= d) {
-            r -= d;
-        }
+static void vi_strncpy(char *dest, const char *src, int n) {
+    int i;
+    for (i = 0; i < n && src[i]; i++) {
+        dest[i] = src[i];
     }
-    return r;
+    dest[i] = '\0';
 }
 
 // ============================================================================
-// Utility Functions
+// Output Buffer
 // ============================================================================
 
-static int vi_strlen(const char *s) {
-    int len = 0;
-    while (s[len]) len++;
-    return len;
-}
+// A whole frame is collected here and written out with one writeOutN, so
+// the console sees long spans instead of one call per character.
+static char vi_out[4096];
+static size_t vi_out_len = 0;
 
-static void vi_strcpy(char *dest, const char *src) {
-    while ((*dest++ = *src++));
+static void vi_flush(void) {
+    writeOutN(vi_out, vi_out_len);
+    vi_out_len = 0;
 }
 
-static void vi_strncpy(char *dest, const char *src, int n) {
-    int i;
-    for (i = 0; i < n && src[i]; i++) {
-        dest[i] = src[i];
+static void vi_putn(const char *s, size_t n) {
+    while (n > 0) {
+        if (vi_out_len == sizeof(vi_out)) vi_flush();
+        size_t chunk = sizeof(vi_out) - vi_out_len;
+        if (chunk > n) chunk = n;
+        memcpy(vi_out + vi_out_len, s, chunk);
+        vi_out_len += chunk;
+        s += chunk;
+        n -= chunk;
     }
-    dest[i] = '\0';
 }
 
-static void vi_memset(void *s, int c, int n) {
-    char *p = (char *)s;
-    while (n--) *p++ = c;
+static void vi_puts(const char *s) {
+    vi_putn(s, strlen(s));
 }
 
-static void vi_memmove(void *dest, const void *src, int n) {
-    char *d = (char *)dest;
-    const char *s = (const char *)src;
-    if (d < s) {
-        while (n--) *d++ = *s++;
-    } else {
-        d += n;
-        s += n;
-        while (n--) *--d = *--s;
-    }
+static void vi_putnum(int n) {
+    char buf[12];
+    char *end = buf + sizeof(buf);
+    char *p = fmt_u32(end, n);
+    vi_putn(p, end - p);
 }
 
 // ============================================================================
@@ -125,137 +107,50 @@ static void vi_memmove(void *dest, const void *src, int n) {
 // ============================================================================
 
 static void vi_clear_screen(void) {
-    writeOut("\033[2J");
+    vi_puts("\033[2J");
 }
 
 static void vi_cursor_home(void) {
-    writeOut("\033[H");
+    vi_puts("\033[H");
 }
 
 static void vi_cursor_move(int row, int col) {
     // ANSI: ESC[row;colH (1-indexed)
-    writeOut("\033[");
-    writeOutNum(row + 1);
-    writeOut(";");
-    writeOutNum(col + 1);
-    writeOut("H");
+    vi_puts("\033[");
+    vi_putnum(row + 1);
+    vi_puts(";");
+    vi_putnum(col + 1);
+    vi_puts("H");
 }
 
 static void vi_clear_line(void) {
-    writeOut("\033[K");
+    vi_puts("\033[K");
 }
 
 static void vi_inverse_on(void) {
-    writeOut("\033[7m");
+    vi_puts("\033[7m");
 }
 
 static void vi_inverse_off(void) {
-    writeOut("\033[0m");
+    vi_puts("\033[0m");
 }
 
 static void vi_hide_cursor(void) {
-    writeOut("\033[?25l");
+    vi_puts("\033[?25l");
 }
 
 static void vi_show_cursor(void) {
-    writeOut("\033[?25h");
+    vi_puts("\033[?25h");
 }
 
 // ============================================================================
 // Input Handling
 // ============================================================================
 
-// Special key codes (returned as negative values to distinguish from ASCII)
-#define KEY_UP      -1
-#define KEY_DOWN    -2
-#define KEY_LEFT    -3
-#define KEY_RIGHT   -4
-
-// Check if UART has data
-static int vi_uart_has_data(void) {
-    return !(*UART0_FR & UART0_FR_RXFE);
-}
-
-// Extended key state for PS/2
-static int extended_key = 0;
-
-// Get a character from either UART or PS/2 keyboard
-// Returns ASCII char, or negative KEY_* values for special keys
+// Get a key from either UART or PS/2 keyboard
+// Returns ASCII char, or KEY_* codes (io/input.h) for special keys
 static int vi_getchar(void) {
-    ps2_init();
-    while (1) {
-        // Check UART first
-        if (vi_uart_has_data()) {
-            return (int)(*UART0_DR & 0xFF);
-        }
-        // Check PS/2 keyboard
-        if (ps2_has_key()) {
-            unsigned char scancode = ps2_get_scancode();
-
-            // 0xE0 = extended key prefix (arrow keys, etc.)
-            if (scancode == 0xE0) {
-                extended_key = 1;
-                continue;
-            }
-
-            // 0xF0 = key release prefix
-            if (scancode == 0xF0) {
-                release_next = 1;
-                continue;
-            }
-
-            if (release_next) {
-                release_next = 0;
-                extended_key = 0;
-                if (scancode == 0x12 || scancode == 0x59) {
-                    shift_pressed = 0;
-                }
-                if (scancode == 0x14) {
-                    ctrl_pressed = 0;
-                }
-                continue;
-            }
-
-            // Handle extended keys (arrow keys with E0 prefix)
-            if (extended_key) {
-                extended_key = 0;
-                switch (scancode) {
-                    case 0x75: return KEY_UP;
-                    case 0x72: return KEY_DOWN;
-                    case 0x6B: return KEY_LEFT;
-                    case 0x74: return KEY_RIGHT;
-                }
-                continue;  // Unknown extended key, ignore
-            }
-
-            // Also handle arrow keys WITHOUT E0 prefix (QEMU sometimes does this)
-            // These are the same scancodes as numpad keys but we prioritize arrow behavior
-            switch (scancode) {
-                case 0x75: return KEY_UP;     // Up arrow / numpad 8
-                case 0x72: return KEY_DOWN;   // Down arrow / numpad 2
-                case 0x6B: return KEY_LEFT;   // Left arrow / numpad 4
-                case 0x74: return KEY_RIGHT;  // Right arrow / numpad 6
-            }
-
-            // Shift keys
-            if (scancode == 0x12 || scancode == 0x59) {
-                shift_pressed = 1;
-                continue;
-            }
-
-            // Ctrl key (0x14)
-            if (scancode == 0x14) {
-                ctrl_pressed = 1;
-                continue;
-            }
-
-            char c = shift_pressed ?
-                scancode_set2_shift[scancode] :
-                scancode_set2[scancode];
-
-            if (c != 0) return (int)c;
-        }
-    }
+    return input_getkey();
 }
 
 // ============================================================================
@@ -267,22 +162,27 @@ static int vi_load_file(const char *path) {
     
     // Initialize buffer
     vi.line_count = 1;
-    vi_memset(vi.buffer, 0, sizeof(vi.buffer));
+    memset(vi.buffer, 0, sizeof(vi.buffer));
+    
+    if (!fat32_is_initialized()) {
+        strcpy(vi.status_msg, "[No filesystem]");
+        return 0;
+    }
     
     if (!fat32_exists(path)) {
         // New file
-        vi_strcpy(vi.status_msg, "[New File]");
+        strcpy(vi.status_msg, "[New File]");
         return 0;
     }
     
     if (fat32_is_directory(path)) {
-        vi_strcpy(vi.status_msg, "Error: Is a directory");
+        strcpy(vi.status_msg, "Error: Is a directory");
         return -1;
     }
     
     int bytes = fat32_read_file(path, file_buf, sizeof(file_buf) - 1);
     if (bytes < 0) {
-        vi_strcpy(vi.status_msg, "Error reading file");
+        strcpy(vi.status_msg, "Error reading file");
         return -1;
     }
     
@@ -308,12 +208,12 @@ static int vi_load_file(const char *path) {
     vi.line_count = line + 1;
     
     // Status message
-    vi_strcpy(vi.status_msg, "\"");
-    int slen = vi_strlen(vi.status_msg);
+    strcpy(vi.status_msg, "\"");
+    int slen = strlen(vi.status_msg);
     vi_strncpy(vi.status_msg + slen, path, 40);
-    slen = vi_strlen(vi.status_msg);
-    vi_strcpy(vi.status_msg + slen, "\" ");
-    slen = vi_strlen(vi.status_msg);
+    slen = strlen(vi.status_msg);
+    strcpy(vi.status_msg + slen, "\" ");
+    slen = strlen(vi.status_msg);
     
     return 0;
 }
@@ -322,12 +222,20 @@ static int vi_save_file(void) {
     static char file_buf[VI_MAX_FILE_SIZE];
     int pos = 0;
     
+    if (!fat32_is_initialized()) {
+        strcpy(vi.status_msg, "Error: Filesystem not mounted");
+        return -1;
+    }
+    
     // Build file content from lines
     for (int i = 0; i < vi.line_count; i++) {
-        int len = vi_strlen(vi.buffer[i]);
-        for (int j = 0; j < len && pos < VI_MAX_FILE_SIZE - 2; j++) {
-            file_buf[pos++] = vi.buffer[i][j];
+        int len = strlen(vi.buffer[i]);
+        int room = VI_MAX_FILE_SIZE - 2 - pos;
+        if (len > room) {
+            len = room > 0 ? room : 0;
         }
+        memcpy(&file_buf[pos], vi.buffer[i], len);
+        pos += len;
         if (i < vi.line_count - 1 && pos < VI_MAX_FILE_SIZE - 1) {
             file_buf[pos++] = '\n';
         }
@@ -338,38 +246,19 @@ static int vi_save_file(void) {
     
     if (result >= 0) {
         vi.modified = 0;
-        vi_strcpy(vi.status_msg, "Written ");
-        int slen = vi_strlen(vi.status_msg);
-        // Count bytes written
-        int digits[12];
-        int num_digits = 0;
-        int n = pos;
-        if (n == 0) {
-            digits[num_digits++] = 0;
-        }
-        while (n > 0) {
-            digits[num_digits++] = vi_mod(n, 10);
-            n = vi_div(n, 10);
-        }
-        for (int i = num_digits - 1; i >= 0; i--) {
-            vi.status_msg[slen++] = '0' + digits[i];
-        }
-        vi_strcpy(vi.status_msg + slen, " bytes");
+        ksnprintf(vi.status_msg, sizeof(vi.status_msg), "Written %d bytes", pos);
         return 0;
     } else {
         // Show specific error code
-        vi_strcpy(vi.status_msg, "Write error: ");
-        int slen = vi_strlen(vi.status_msg);
+        strcpy(vi.status_msg, "Write error: ");
+        int slen = strlen(vi.status_msg);
         int err = -result;  // Make positive
-        if (err == 1) vi_strcpy(vi.status_msg + slen, "FS not init");
-        else if (err == 2) vi_strcpy(vi.status_msg + slen, "Is directory");
-        else if (err == 3) vi_strcpy(vi.status_msg + slen, "Bad parent");
-        else if (err == 4) vi_strcpy(vi.status_msg + slen, "No space");
-        else if (err == 5) vi_strcpy(vi.status_msg + slen, "Write failed");
-        else {
-            vi.status_msg[slen++] = '0' + err;
-            vi.status_msg[slen] = '\0';
-        }
+        if (err == 1) strcpy(vi.status_msg + slen, "FS not init");
+        else if (err == 2) strcpy(vi.status_msg + slen, "Is directory");
+        else if (err == 3) strcpy(vi.status_msg + slen, "Bad parent");
+        else if (err == 4) strcpy(vi.status_msg + slen, "No space");
+        else if (err == 5) strcpy(vi.status_msg + slen, "Write failed");
+        else ksnprintf(vi.status_msg + slen, sizeof(vi.status_msg) - slen, "%d", err);
         return -1;
     }
 }
@@ -381,6 +270,48 @@ static int vi_save_file(void) {
 // Cursor blink state (toggled each screen draw)
 static int cursor_visible = 1;
 
+// What each text row shows (its text and the cursor column, -1 if the
+// cursor is elsewhere), so a draw only rewrites rows that changed
+#define VI_TEXT_ROWS    (VI_SCREEN_ROWS - 1)
+#define VI_ROW_STALE    -2
+
+static char vi_shown[VI_TEXT_ROWS][VI_SCREEN_COLS];
+static int vi_shown_cursor[VI_TEXT_ROWS];
+static int vi_shown_offset = 0;
+
+static void vi_invalidate_rows(int from, int to) {
+    for (int i = from; i < to; i++) {
+        vi_shown_cursor[i] = VI_ROW_STALE;
+    }
+}
+
+// Follow a scroll of delta lines with a region scroll of the text rows:
+// the rows still on screen move, and only the new ones get redrawn
+static void vi_scroll_rows(int delta) {
+    vi_puts("\033[1;");
+    vi_putnum(VI_TEXT_ROWS);
+    vi_puts("r");                       // Also homes the cursor
+    vi_puts("\033[");
+    if (delta > 0) {
+        vi_putnum(delta);
+        vi_puts("M");                   // Delete lines at the top
+        for (int i = 0; i < VI_TEXT_ROWS - delta; i++) {
+            memcpy(vi_shown[i], vi_shown[i + delta], VI_SCREEN_COLS);
+            vi_shown_cursor[i] = vi_shown_cursor[i + delta];
+        }
+        vi_invalidate_rows(VI_TEXT_ROWS - delta, VI_TEXT_ROWS);
+    } else {
+        vi_putnum(-delta);
+        vi_puts("L");                   // Insert lines at the top
+        for (int i = VI_TEXT_ROWS - 1; i >= -delta; i--) {
+            memcpy(vi_shown[i], vi_shown[i + delta], VI_SCREEN_COLS);
+            vi_shown_cursor[i] = vi_shown_cursor[i + delta];
+        }
+        vi_invalidate_rows(0, -delta);
+    }
+    vi_puts("\033[r");
+}
+
 static void vi_draw_screen(void) {
     vi_hide_cursor();
     vi_cursor_home();
@@ -390,38 +321,55 @@ static void vi_draw_screen(void) {
     
     // Calculate screen position of cursor
     int cursor_screen_row = vi.cursor_row - vi.scroll_offset;
+
+    // Scroll what is already on screen when that saves redrawing
+    int delta = vi.scroll_offset - vi_shown_offset;
+    if (delta > -VI_TEXT_ROWS && delta < VI_TEXT_ROWS) {
+        if (delta != 0) vi_scroll_rows(delta);
+    } else {
+        vi_invalidate_rows(0, VI_TEXT_ROWS);
+    }
+    vi_shown_offset = vi.scroll_offset;
     
-    // Draw text lines
-    for (int i = 0; i < VI_SCREEN_ROWS - 1; i++) {
+    // Draw text lines that differ from what is shown
+    for (int i = 0; i < VI_TEXT_ROWS; i++) {
         int line_num = vi.scroll_offset + i;
-        
+        const char *line = "~";         // Tilde for empty lines
+        int cursor = -1;
+        if (line_num < vi.line_count) {
+            line = vi.buffer[line_num];
+            if (i == cursor_screen_row) cursor = vi.cursor_col;
+        }
+
+        int len = strlen(line);
+        int shown = len < VI_SCREEN_COLS - 1 ? len : VI_SCREEN_COLS - 1;
+        if (vi_shown_cursor[i] == cursor &&
+            strncmp(vi_shown[i], line, shown) == 0 && vi_shown[i][shown] == '\0') {
+            continue;
+        }
+        memcpy(vi_shown[i], line, shown);
+        vi_shown[i][shown] = '\0';
+        vi_shown_cursor[i] = cursor;
+
         vi_cursor_move(i, 0);
         vi_clear_line();
-        
-        if (line_num < vi.line_count) {
-            // Draw the line content (truncate if too long)
-            int len = vi_strlen(vi.buffer[line_num]);
-            for (int j = 0; j < len && j < VI_SCREEN_COLS - 1; j++) {
-                // Check if this is cursor position - draw inverse or underscore
-                if (i == cursor_screen_row && j == vi.cursor_col) {
-                    vi_inverse_on();
-                    char ch[2] = {vi.buffer[line_num][j], '\0'};
-                    writeOut(ch);
-                    vi_inverse_off();
-                } else {
-                    char ch[2] = {vi.buffer[line_num][j], '\0'};
-                    writeOut(ch);
-                }
-            }
-            // If cursor is at end of line (insert mode), draw block cursor
-            if (i == cursor_screen_row && vi.cursor_col >= len) {
-                vi_inverse_on();
-                writeOut(" ");
-                vi_inverse_off();
-            }
+
+        if (cursor >= 0 && cursor < shown) {
+            // Text before the cursor, the cursor cell in inverse, the rest
+            vi_putn(line, cursor);
+            vi_inverse_on();
+            vi_putn(line + cursor, 1);
+            vi_inverse_off();
+            vi_putn(line + cursor + 1, shown - cursor - 1);
         } else {
-            // Draw tilde for empty lines
-            writeOut("~");
+            vi_putn(line, shown);
+        }
+
+        // If cursor is at end of line (insert mode), draw block cursor
+        if (cursor >= 0 && cursor >= len) {
+            vi_inverse_on();
+            vi_puts(" ");
+            vi_inverse_off();
         }
     }
     
@@ -430,33 +378,33 @@ static void vi_draw_screen(void) {
     vi_inverse_on();
     
     // Left side: filename and modified flag
-    writeOut(" ");
+    vi_puts(" ");
     if (vi.filename[0]) {
-        writeOut(vi.filename);
+        vi_puts(vi.filename);
     } else {
-        writeOut("[No Name]");
+        vi_puts("[No Name]");
     }
     if (vi.modified) {
-        writeOut(" [+]");
+        vi_puts(" [+]");
     }
     
     // Mode indicator
-    writeOut(" - ");
+    vi_puts(" - ");
     switch (vi.mode) {
-        case MODE_NORMAL:  writeOut("NORMAL"); break;
-        case MODE_INSERT:  writeOut("-- INSERT --"); break;
-        case MODE_REPLACE: writeOut("-- REPLACE --"); break;
-        case MODE_COMMAND: writeOut(":"); writeOut(vi.cmd_buffer); break;
+        case MODE_NORMAL:  vi_puts("NORMAL"); break;
+        case MODE_INSERT:  vi_puts("-- INSERT --"); break;
+        case MODE_REPLACE: vi_puts("-- REPLACE --"); break;
+        case MODE_COMMAND: vi_puts(":"); vi_puts(vi.cmd_buffer); break;
     }
     
     // Right side: position
-    writeOut(" | Line ");
-    writeOutNum(vi.cursor_row + 1);
-    writeOut("/");
-    writeOutNum(vi.line_count);
-    writeOut(", Col ");
-    writeOutNum(vi.cursor_col + 1);
-    writeOut(" ");
+    vi_puts(" | Line ");
+    vi_putnum(vi.cursor_row + 1);
+    vi_puts("/");
+    vi_putnum(vi.line_count);
+    vi_puts(", Col ");
+    vi_putnum(vi.cursor_col + 1);
+    vi_puts(" ");
     
     // Clear rest of status line
     vi_clear_line();
@@ -465,12 +413,13 @@ static void vi_draw_screen(void) {
     // Show status message if any
     if (vi.status_msg[0] && vi.mode != MODE_COMMAND) {
         vi_cursor_move(VI_SCREEN_ROWS - 1, 50);
-        writeOut(vi.status_msg);
+        vi_puts(vi.status_msg);
     }
     
     // Position cursor
     vi_cursor_move(vi.cursor_row - vi.scroll_offset, vi.cursor_col);
     vi_show_cursor();
+    vi_flush();
 }
 
 // Ensure cursor is visible on screen
@@ -485,7 +434,7 @@ static void vi_scroll_to_cursor(void) {
 
 // Clamp cursor column to valid range
 static void vi_clamp_cursor(void) {
-    int line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+    int line_len = strlen(vi.buffer[vi.cursor_row]);
     if (vi.mode == MODE_INSERT) {
         // In insert mode, cursor can be at end of line
         if (vi.cursor_col > line_len) {
@@ -507,14 +456,14 @@ static void vi_clamp_cursor(void) {
 // ============================================================================
 
 static void vi_insert_char(char c) {
-    int line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+    int line_len = strlen(vi.buffer[vi.cursor_row]);
     
     if (line_len >= VI_MAX_LINE_LEN - 1) return;
     
     // Shift characters right
-    vi_memmove(&vi.buffer[vi.cursor_row][vi.cursor_col + 1],
-               &vi.buffer[vi.cursor_row][vi.cursor_col],
-               line_len - vi.cursor_col + 1);
+    memmove(&vi.buffer[vi.cursor_row][vi.cursor_col + 1],
+            &vi.buffer[vi.cursor_row][vi.cursor_col],
+            line_len - vi.cursor_col + 1);
     
     vi.buffer[vi.cursor_row][vi.cursor_col] = c;
     vi.cursor_col++;
@@ -526,11 +475,11 @@ static void vi_insert_newline(void) {
     
     // Make room for new line
     for (int i = vi.line_count; i > vi.cursor_row + 1; i--) {
-        vi_strcpy(vi.buffer[i], vi.buffer[i - 1]);
+        strcpy(vi.buffer[i], vi.buffer[i - 1]);
     }
     
     // Split current line
-    vi_strcpy(vi.buffer[vi.cursor_row + 1], &vi.buffer[vi.cursor_row][vi.cursor_col]);
+    strcpy(vi.buffer[vi.cursor_row + 1], &vi.buffer[vi.cursor_row][vi.cursor_col]);
     vi.buffer[vi.cursor_row][vi.cursor_col] = '\0';
     
     vi.line_count++;
@@ -540,14 +489,14 @@ static void vi_insert_newline(void) {
 }
 
 static void vi_delete_char(void) {
-    int line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+    int line_len = strlen(vi.buffer[vi.cursor_row]);
     
     if (vi.cursor_col >= line_len) return;
     
     // Shift characters left
-    vi_memmove(&vi.buffer[vi.cursor_row][vi.cursor_col],
-               &vi.buffer[vi.cursor_row][vi.cursor_col + 1],
-               line_len - vi.cursor_col);
+    memmove(&vi.buffer[vi.cursor_row][vi.cursor_col],
+            &vi.buffer[vi.cursor_row][vi.cursor_col + 1],
+            line_len - vi.cursor_col);
     
     vi.modified = 1;
 }
@@ -558,17 +507,17 @@ static void vi_backspace(void) {
         vi_delete_char();
     } else if (vi.cursor_row > 0) {
         // Join with previous line
-        int prev_len = vi_strlen(vi.buffer[vi.cursor_row - 1]);
-        int curr_len = vi_strlen(vi.buffer[vi.cursor_row]);
+        int prev_len = strlen(vi.buffer[vi.cursor_row - 1]);
+        int curr_len = strlen(vi.buffer[vi.cursor_row]);
         
         if (prev_len + curr_len < VI_MAX_LINE_LEN - 1) {
             // Append current line to previous
-            vi_strcpy(&vi.buffer[vi.cursor_row - 1][prev_len],
+            strcpy(&vi.buffer[vi.cursor_row - 1][prev_len],
                      vi.buffer[vi.cursor_row]);
             
             // Shift lines up
             for (int i = vi.cursor_row; i < vi.line_count - 1; i++) {
-                vi_strcpy(vi.buffer[i], vi.buffer[i + 1]);
+                strcpy(vi.buffer[i], vi.buffer[i + 1]);
             }
             
             vi.line_count--;
@@ -587,7 +536,7 @@ static void vi_delete_line(void) {
     } else {
         // Shift lines up
         for (int i = vi.cursor_row; i < vi.line_count - 1; i++) {
-            vi_strcpy(vi.buffer[i], vi.buffer[i + 1]);
+            strcpy(vi.buffer[i], vi.buffer[i + 1]);
         }
         vi.line_count--;
         
@@ -602,20 +551,20 @@ static void vi_delete_line(void) {
 static void vi_join_lines(void) {
     if (vi.cursor_row >= vi.line_count - 1) return;
     
-    int curr_len = vi_strlen(vi.buffer[vi.cursor_row]);
-    int next_len = vi_strlen(vi.buffer[vi.cursor_row + 1]);
+    int curr_len = strlen(vi.buffer[vi.cursor_row]);
+    int next_len = strlen(vi.buffer[vi.cursor_row + 1]);
     
     if (curr_len + next_len + 1 < VI_MAX_LINE_LEN) {
         // Add space between lines
         if (curr_len > 0) {
             vi.buffer[vi.cursor_row][curr_len++] = ' ';
         }
-        vi_strcpy(&vi.buffer[vi.cursor_row][curr_len],
+        strcpy(&vi.buffer[vi.cursor_row][curr_len],
                  vi.buffer[vi.cursor_row + 1]);
         
         // Shift lines up
         for (int i = vi.cursor_row + 1; i < vi.line_count - 1; i++) {
-            vi_strcpy(vi.buffer[i], vi.buffer[i + 1]);
+            strcpy(vi.buffer[i], vi.buffer[i + 1]);
         }
         vi.line_count--;
         vi.modified = 1;
@@ -627,7 +576,7 @@ static void vi_open_line_below(void) {
     
     // Make room for new line
     for (int i = vi.line_count; i > vi.cursor_row + 1; i--) {
-        vi_strcpy(vi.buffer[i], vi.buffer[i - 1]);
+        strcpy(vi.buffer[i], vi.buffer[i - 1]);
     }
     
     vi.buffer[vi.cursor_row + 1][0] = '\0';
@@ -643,7 +592,7 @@ static void vi_open_line_above(void) {
     
     // Make room for new line
     for (int i = vi.line_count; i > vi.cursor_row; i--) {
-        vi_strcpy(vi.buffer[i], vi.buffer[i - 1]);
+        strcpy(vi.buffer[i], vi.buffer[i - 1]);
     }
     
     vi.buffer[vi.cursor_row][0] = '\0';
@@ -663,7 +612,7 @@ static int vi_execute_command(void) {
     
     if (strcmp(vi.cmd_buffer, "q") == 0) {
         if (vi.modified) {
-            vi_strcpy(vi.status_msg, "No write since last change (add ! to override)");
+            strcpy(vi.status_msg, "No write since last change (add ! to override)");
             return 0;
         }
         return 1;  // Quit
@@ -675,7 +624,7 @@ static int vi_execute_command(void) {
     
     if (strcmp(vi.cmd_buffer, "w") == 0) {
         if (!vi.filename[0]) {
-            vi_strcpy(vi.status_msg, "No file name");
+            strcpy(vi.status_msg, "No file name");
             return 0;
         }
         vi_save_file();
@@ -684,7 +633,7 @@ static int vi_execute_command(void) {
     
     if (strcmp(vi.cmd_buffer, "wq") == 0 || strcmp(vi.cmd_buffer, "x") == 0) {
         if (!vi.filename[0]) {
-            vi_strcpy(vi.status_msg, "No file name");
+            strcpy(vi.status_msg, "No file name");
             return 0;
         }
         if (vi_save_file() == 0) {
@@ -723,8 +672,8 @@ static int vi_execute_command(void) {
     }
     
     if (vi.cmd_buffer[0]) {
-        vi_strcpy(vi.status_msg, "Unknown command: ");
-        int slen = vi_strlen(vi.status_msg);
+        strcpy(vi.status_msg, "Unknown command: ");
+        int slen = strlen(vi.status_msg);
         vi_strncpy(vi.status_msg + slen, vi.cmd_buffer, 30);
     }
     
@@ -756,7 +705,7 @@ static int vi_handle_normal(int c) {
         return 0;
     }
     if (c == KEY_RIGHT) {
-        line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+        line_len = strlen(vi.buffer[vi.cursor_row]);
         if (vi.cursor_col < line_len - 1) vi.cursor_col++;
         return 0;
     }
@@ -775,13 +724,13 @@ static int vi_handle_normal(int c) {
             vi_clamp_cursor();
             break;
         case 'l':  // Right
-            line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+            line_len = strlen(vi.buffer[vi.cursor_row]);
             if (vi.cursor_col < line_len - 1) vi.cursor_col++;
             break;
             
         // Word movement
         case 'w':  // Word forward
-            line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+            line_len = strlen(vi.buffer[vi.cursor_row]);
             // Skip current word
             while (vi.cursor_col < line_len && 
                    vi.buffer[vi.cursor_row][vi.cursor_col] != ' ') {
@@ -812,7 +761,7 @@ static int vi_handle_normal(int c) {
             vi.cursor_col = 0;
             break;
         case '$':  // End of line
-            line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+            line_len = strlen(vi.buffer[vi.cursor_row]);
             vi.cursor_col = line_len > 0 ? line_len - 1 : 0;
             break;
         case '^':  // First non-space
@@ -838,7 +787,7 @@ static int vi_handle_normal(int c) {
             vi.mode = MODE_INSERT;
             break;
         case 'a':  // Insert after cursor
-            line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+            line_len = strlen(vi.buffer[vi.cursor_row]);
             if (line_len > 0) vi.cursor_col++;
             vi.mode = MODE_INSERT;
             break;
@@ -847,7 +796,7 @@ static int vi_handle_normal(int c) {
             vi.mode = MODE_INSERT;
             break;
         case 'A':  // Insert at end of line
-            vi.cursor_col = vi_strlen(vi.buffer[vi.cursor_row]);
+            vi.cursor_col = strlen(vi.buffer[vi.cursor_row]);
             vi.mode = MODE_INSERT;
             break;
         case 'o':  // Open line below
@@ -886,7 +835,7 @@ static int vi_handle_normal(int c) {
             {
                 char replacement = vi_getchar();
                 if (replacement >= 32 && replacement < 127) {
-                    line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+                    line_len = strlen(vi.buffer[vi.cursor_row]);
                     if (vi.cursor_col < line_len) {
                         vi.buffer[vi.cursor_row][vi.cursor_col] = replacement;
                         vi.modified = 1;
@@ -930,7 +879,7 @@ static int vi_handle_insert(int c) {
         return 0;
     }
     if (c == KEY_RIGHT) {
-        int line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+        int line_len = strlen(vi.buffer[vi.cursor_row]);
         if (vi.cursor_col < line_len) vi.cursor_col++;
         return 0;
     }
@@ -993,7 +942,7 @@ static int vi_handle_replace(int c) {
             
         default:
             if (c >= 32 && c < 127) {
-                line_len = vi_strlen(vi.buffer[vi.cursor_row]);
+                line_len = strlen(vi.buffer[vi.cursor_row]);
                 if (vi.cursor_col < line_len) {
                     vi.buffer[vi.cursor_row][vi.cursor_col] = (char)c;
                     vi.cursor_col++;
@@ -1010,7 +959,7 @@ static int vi_handle_replace(int c) {
 
 static int vi_handle_command(int c) {
     // Ignore arrow keys in command mode
-    if (c < 0) return 0;
+    if (KEY_IS_SPECIAL(c)) return 0;
     
     switch (c) {
         case 27:  // Escape - cancel command
@@ -1055,14 +1004,8 @@ static int vi_handle_command(int c) {
 // ============================================================================
 
 void prog_vi(const char *filename) {
-    // Check filesystem
-    if (!fat32_is_initialized()) {
-        writeOut("Error: Filesystem not mounted. Run 'setup' first.\n");
-        return;
-    }
-    
     // Initialize editor state
-    vi_memset(&vi, 0, sizeof(vi));
+    memset(&vi, 0, sizeof(vi));
     vi.line_count = 1;
     vi.mode = MODE_NORMAL;
     
@@ -1076,11 +1019,12 @@ void prog_vi(const char *filename) {
     if (vi.filename[0]) {
         vi_load_file(vi.filename);
     } else {
-        vi_strcpy(vi.status_msg, "[New File]");
+        strcpy(vi.status_msg, "[New File]");
     }
     
     // Clear screen and start
     vi_clear_screen();
+    vi_invalidate_rows(0, VI_TEXT_ROWS);
     
     // Main loop
     int running = 1;
@@ -1109,3 +1053,11 @@ void prog_vi(const char *filename) {
     // Minimal exit - just return to shell
     // Don't do any cleanup that might crash
 }
+
+static int vi_main(int argc, char **argv) {
+    prog_vi(argc > 1 ? argv[1] : 0);
+    return 0;
+}
+SHELL_COMMAND(vi, vi_main, SH_FILES, "[file]", "Edit file with vi editor");
+
+#endif // CONFIG_VI
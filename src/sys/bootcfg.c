@@ -0,0 +1,159 @@
+/*
+ * Boot configuration
+ */
+
+#include "bootcfg.h"
+#include "bootinfo.h"
+#include "klog.h"
+#include <drivers/writeDriver.h>
+#include <io/shell.h>
+
+// Prel.c
+int MountPartition(u32 start);
+void SelectParition(void);
+
+// One byte past the limit to spot a longer file, plus the terminator
+static char bootcfg_text[BOOTCFG_MAX_SIZE + 2];
+static const char *bootcfg_run[BOOTCFG_MAX_RUN];
+static int bootcfg_run_count = 0;
+
+// Decimal number up to BOOTCFG_NUMBER_MAX, or -1 if s is not one
+#define BOOTCFG_NUMBER_MAX  0xFFFF
+
+static int bootcfg_number(const char *s) {
+    u32 v = 0;
+    if (!*s) return -1;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return -1;
+        v = v * 10 + (u32)(*s - '0');
+        if (v > BOOTCFG_NUMBER_MAX) return -1;
+    }
+    return (int)v;
+}
+
+static int bootcfg_is_fat32(u8 type) {
+    return type == 0x0B || type == 0x0C;
+}
+
+// Active FAT32 partition, else the first FAT32 one, else the first entry
+static int bootcfg_pick(const u8 *types, const u8 *flags, int count) {
+    for (int i = 0; i < count; i++) {
+        if ((flags[i] & 0x80) && bootcfg_is_fat32(types[i])) return i;
+    }
+    for (int i = 0; i < count; i++) {
+        if (bootcfg_is_fat32(types[i])) return i;
+    }
+    return 0;
+}
+
+// Apply one key=value line (trimmed, non-empty)
+static void bootcfg_apply(char *key, char *value, u32 *starts, int count,
+                          int *mounted) {
+    if (strcmp(key, "mount") == 0) {
+        if (boot_option("root", 0, 0)) return;     // Command line wins
+        if (strcmp(value, "auto") == 0) return;
+        if (strcmp(value, "menu") == 0) {
+            SelectParition();
+            return;
+        }
+        int index = bootcfg_number(value);
+        if (index < 0 || index >= count) {
+            klog("bootcfg: no partition %s", value);
+        } else if (index != *mounted) {
+            if (MountPartition(starts[index]) == 0) *mounted = index;
+        }
+    } else if (strcmp(key, "cache") == 0) {
+        int n = bootcfg_number(value);
+        if (n < 0) {
+            klog("bootcfg: bad cache size %s", value);
+        } else {
+            klog("bootcfg: FAT cache %u sectors", fat32_cache_set_size(n));
+        }
+    } else if (strcmp(key, "discard") == 0) {
+        fat32_set_discard(strcmp(value, "on") == 0);
+    } else if (strcmp(key, "run") == 0) {
+        if (bootcfg_run_count < BOOTCFG_MAX_RUN) {
+            bootcfg_run[bootcfg_run_count++] = value;
+        } else {
+            klog("bootcfg: too many run lines, dropped %s", value);
+        }
+    } else {
+        klog("bootcfg: unknown key %s", key);
+    }
+}
+
+// Split the file into lines and apply each setting in order. Values are
+// left in place in bootcfg_text, which the run list points into.
+static void bootcfg_parse(char *text, u32 *starts, int count, int *mounted) {
+    char *line = text;
+    while (*line) {
+        char *end = line;
+        while (*end && *end != '\n') end++;
+        char *next = *end ? end + 1 : end;
+        *end = '\0';
+
+        char *hash = line;
+        while (*hash && *hash != '#') hash++;
+        *hash = '\0';
+
+        char *eq = line;
+        while (*eq && *eq != '=') eq++;
+        if (*eq == '=') {
+            *eq = '\0';
+            char *key = line;
+            char *value = eq + 1;
+
+            // Trim both sides of the key and the value (and any '\r')
+            while (*key == ' ' || *key == '\t') key++;
+            for (char *p = eq - 1; p >= key && (*p == ' ' || *p == '\t'); p--) *p = '\0';
+            while (*value == ' ' || *value == '\t') value++;
+            for (char *p = hash - 1; p >= value &&
+                 (*p == ' ' || *p == '\t' || *p == '\r'); p--) *p = '\0';
+
+            if (*key && *value) bootcfg_apply(key, value, starts, count, mounted);
+        }
+
+        line = next;
+    }
+}
+
+void bootcfg_load(void) {
+    u8 types[4];
+    u8 flags[4];
+    u32 starts[4];
+    u32 sizes[4];
+    int count = fat32_read_partitions(types, flags, starts, sizes, 4);
+    if (count <= 0) {
+        writeOut("No partitions found; starting without a filesystem\n");
+        return;
+    }
+
+    int mounted = bootcfg_pick(types, flags, count);
+    u32 root = boot_option_u32("root", (u32)mounted);
+    if (root < (u32)count) {
+        mounted = (int)root;
+    } else {
+        kprintf("No partition %u; using the default\n", root);
+    }
+    if (MountPartition(starts[mounted]) != 0) return;
+
+    // A truncated file would end in a cut-off line (run=rm /logs/o), so
+    // refuse it whole rather than apply part of it
+    int n = fat32_read_file(BOOTCFG_PATH, bootcfg_text, BOOTCFG_MAX_SIZE + 1);
+    if (n <= 0) return;
+    if (n > BOOTCFG_MAX_SIZE) {
+        klog("bootcfg: %s is over %d bytes; ignored", BOOTCFG_PATH, BOOTCFG_MAX_SIZE);
+        return;
+    }
+    bootcfg_text[n] = '\0';
+
+    klog("bootcfg: %s from partition %d", BOOTCFG_PATH, mounted);
+    bootcfg_parse(bootcfg_text, starts, count, &mounted);
+}
+
+void bootcfg_autostart(void) {
+    for (int i = 0; i < bootcfg_run_count; i++) {
+        kprintf("> %s\n", bootcfg_run[i]);
+        sh_exec(bootcfg_run[i]);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef BOOTCFG_H
+#define BOOTCFG_H
+
+/*
+ * Boot configuration
+ *
+ * At boot the partition given by the `root=` boot option, or else the
+ * card's active partition, or else the first FAT32 one, is mounted without
+ * asking, and SPARK.CFG is read from its root. The file
+ * holds one key=value per line; '#' starts a comment:
+ *
+ *   mount=auto         auto, menu (ask as before) or a partition index;
+ *                      ignored when the command line has root=
+ *   cache=16           FAT sector cache slots, up to the size set at boot
+ *   discard=on         online discard of freed clusters
+ *   run=ls /           shell command to run before the prompt (repeatable)
+ *
+ * Without a card or a config file the defaults apply and nothing waits
+ * for input. A file over BOOTCFG_MAX_SIZE bytes is ignored rather than
+ * applied in part.
+ */
+
+#include <package.h>
+
+#define BOOTCFG_PATH        "/SPARK.CFG"
+#define BOOTCFG_MAX_SIZE    1024
+#define BOOTCFG_MAX_RUN     8
+
+// Mount the boot volume and apply SPARK.CFG
+void bootcfg_load(void);
+
+// Run the configured commands through the shell
+void bootcfg_autostart(void);
+
+#endif
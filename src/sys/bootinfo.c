@@ -0,0 +1,93 @@
+/*
+ * Boot information from the bootloader
+ */
+
+#include "bootinfo.h"
+
+static u32 ram_start = BOOT_RAM_START;
+static u32 ram_size = BOOT_RAM_DEFAULT;
+static char cmdline[BOOT_CMDLINE_MAX];
+
+typedef struct {
+    u32 size;                   // Words, header included
+    u32 tag;
+} atag_header_t;
+
+void bootinfo_parse(u32 atags) {
+    const atag_header_t *h = (const atag_header_t *)atags;
+
+    // The list must be word aligned and start with ATAG_CORE
+    if ((atags & 3) || h->tag != ATAG_CORE) return;
+
+    int have_mem = 0;
+    while (h->size >= 2 && h->tag != ATAG_NONE) {
+        const u32 *data = (const u32 *)(h + 1);
+
+        if (h->tag == ATAG_MEM && !have_mem) {
+            // data[0]: size, data[1]: start; only the first bank is used
+            ram_size = data[0];
+            ram_start = data[1];
+            have_mem = 1;
+        } else if (h->tag == ATAG_CMDLINE) {
+            const char *s = (const char *)data;
+            u32 max = (h->size - 2) * 4;
+            u32 n = 0;
+            while (n < max && n < sizeof(cmdline) - 1 && s[n]) {
+                cmdline[n] = s[n];
+                n++;
+            }
+            cmdline[n] = '\0';
+        }
+
+        h = (const atag_header_t *)((const u32 *)h + h->size);
+    }
+}
+
+u32 boot_ram_start(void) {
+    return ram_start;
+}
+
+u32 boot_ram_size(void) {
+    return ram_size;
+}
+
+const char *boot_cmdline(void) {
+    return cmdline;
+}
+
+int boot_option(const char *name, char *value, size_t size) {
+    size_t len = strlen(name);
+    const char *p = cmdline;
+
+    while (*p) {
+        while (*p == ' ') p++;
+        const char *word = p;
+        while (*p && *p != ' ') p++;
+
+        if (strncmp(word, name, len) != 0) continue;
+        if (word + len != p && word[len] != '=') continue;
+
+        const char *v = word + len;
+        if (*v == '=') v++;
+        size_t n = 0;
+        while (v + n < p && n + 1 < size) {
+            value[n] = v[n];
+            n++;
+        }
+        if (size) value[n] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+u32 boot_option_u32(const char *name, u32 def) {
+    char value[12];
+    if (!boot_option(name, value, sizeof(value)) || !value[0]) return def;
+
+    u32 v = 0;
+    for (const char *s = value; *s; s++) {
+        if (*s < '0' || *s > '9') return def;
+        v = v * 10 + (*s - '0');
+    }
+    return v;
+}
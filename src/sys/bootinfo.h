@@ -0,0 +1,41 @@
+#ifndef BOOTINFO_H
+#define BOOTINFO_H
+
+/*
+ * Boot information from the bootloader
+ *
+ * The loader (or QEMU's -kernel) starts us with r2 pointing at an ATAG
+ * list. boot.s hands r0-r2 to kernel_main, which calls bootinfo_parse()
+ * before anything else can overwrite the list. The memory size and the
+ * command line (qemu -append) are copied out of it; without a valid list
+ * the defaults below apply.
+ */
+
+#include <package.h>
+
+// ATAG headers: size in words (including the header) then the tag
+#define ATAG_NONE           0x00000000
+#define ATAG_CORE           0x54410001
+#define ATAG_MEM            0x54410002
+#define ATAG_CMDLINE        0x54410009
+
+#define BOOT_RAM_START      0x00000000
+#define BOOT_RAM_DEFAULT    (64 * 1024 * 1024)     // Smallest board we run on
+#define BOOT_CMDLINE_MAX    256
+
+void bootinfo_parse(u32 atags);
+
+// First RAM bank
+u32 boot_ram_start(void);
+u32 boot_ram_size(void);
+
+const char *boot_cmdline(void);
+
+// Look up a command line option: "name" or "name=value", space separated.
+// Returns 1 and copies the value ("" for a bare flag) if present, else 0.
+int boot_option(const char *name, char *value, size_t size);
+
+// Numeric option, or def if absent or not a decimal number
+u32 boot_option_u32(const char *name, u32 def);
+
+#endif
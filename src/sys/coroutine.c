@@ -0,0 +1,181 @@
+/*
+ * Coroutines - cooperative tasks run by whichever thread pumps them
+ */
+
+#include "coroutine.h"
+#include "thread.h"
+#include "irq.h"
+#include "klog.h"
+
+static co_t coroutines[CO_MAX];
+static u8 co_stacks[CO_MAX][CO_STACK_SIZE] __attribute__((aligned(8)));
+
+static co_t *co_running = 0;        // Coroutine switched in, 0 in the pump
+static thread_t *co_host = 0;       // Thread currently running the pump
+static u32 *co_host_sp = 0;         // Pump context while a coroutine runs
+static int co_next = 0;             // Round-robin start for the next pump
+
+// ============================================================================
+// Pump
+// ============================================================================
+
+// Can this coroutine run now?
+static int co_runnable(co_t *c) {
+    if (c->state == CO_READY) return 1;
+    if (c->state == CO_WAITING && c->wait_fn(c->wait_arg)) {
+        c->state = CO_READY;
+        c->wait_fn = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// Run every runnable coroutine once on the calling thread
+// Only one thread pumps at a time; a second caller simply returns.
+// Returns how many coroutines ran.
+static int co_pump(void) {
+    u32 flags = irq_save();
+    if (co_host) {
+        irq_restore(flags);
+        return 0;
+    }
+    co_host = thread_current();
+    irq_restore(flags);
+
+    int ran = 0;
+    int start = co_next;
+    for (int n = 0; n < CO_MAX; n++) {
+        int i = (start + n) % CO_MAX;
+        co_t *c = &coroutines[i];
+
+        if (!co_runnable(c)) continue;
+
+        co_running = c;
+        c->switches++;
+        ran++;
+        co_switch(&co_host_sp, c->sp);
+        co_running = 0;
+
+        if (*(u32 *)co_stacks[i] != CO_STACK_CANARY) {
+            // Never resume it; what lies below its stack may be damaged
+            klog("co: %s overflowed its %u-byte stack", c->name, CO_STACK_SIZE);
+            c->state = CO_FREE;
+            continue;
+        }
+        if (c->state == CO_DEAD) {
+            c->state = CO_FREE;
+        }
+    }
+    co_next = (start + 1) % CO_MAX;
+
+    co_host = 0;
+    return ran;
+}
+
+// ============================================================================
+// Coroutine API
+// ============================================================================
+
+co_t *co_self(void) {
+    if (co_running && co_host == thread_current()) {
+        return co_running;
+    }
+    return 0;
+}
+
+int co_active(void) {
+    int n = 0;
+    for (int i = 0; i < CO_MAX; i++) {
+        if (coroutines[i].state == CO_READY || coroutines[i].state == CO_WAITING) {
+            n++;
+        }
+    }
+    return n;
+}
+
+co_t *co_get(int index) {
+    if (index < 0 || index >= CO_MAX) return 0;
+    if (coroutines[index].state == CO_FREE) return 0;
+    return &coroutines[index];
+}
+
+// Start a coroutine; it first runs on the next pump
+co_t *co_spawn(const char *name, co_entry_t entry, void *arg) {
+    u32 flags = irq_save();
+
+    co_t *c = 0;
+    int slot;
+    for (slot = 0; slot < CO_MAX; slot++) {
+        if (coroutines[slot].state == CO_FREE) {
+            c = &coroutines[slot];
+            break;
+        }
+    }
+    if (!c) {
+        irq_restore(flags);
+        return 0;
+    }
+
+    memset(c, 0, sizeof(*c));
+    int i = 0;
+    while (name[i] && i < CO_NAME_LEN - 1) {
+        c->name[i] = name[i];
+        i++;
+    }
+    c->name[i] = '\0';
+
+    *(u32 *)co_stacks[slot] = CO_STACK_CANARY;
+
+    // Initial frame popped by co_switch: r4-r11, then lr
+    u32 *sp = (u32 *)(co_stacks[slot] + CO_STACK_SIZE);
+    *--sp = (u32)co_trampoline;         // lr
+    for (int r = 11; r >= 4; r--) {
+        *--sp = 0;
+    }
+    sp[0] = (u32)entry;                 // r4
+    sp[1] = (u32)arg;                   // r5
+    c->sp = sp;
+
+    c->state = CO_READY;
+    irq_restore(flags);
+    return c;
+}
+
+// Return to the pump; the slot is freed once we are off its stack
+void co_exit(void) {
+    co_t *self = co_running;
+    self->state = CO_DEAD;
+    co_switch(&self->sp, co_host_sp);
+
+    while (1);  // Not reached
+}
+
+void co_yield(void) {
+    co_t *self = co_self();
+    if (self) {
+        co_switch(&self->sp, co_host_sp);
+    } else {
+        co_pump();
+    }
+}
+
+void co_await_io(co_ready_fn ready, void *arg) {
+    if (ready(arg)) return;
+
+    co_t *self = co_self();
+    if (self) {
+        // The pump polls ready() and only switches back in once it holds
+        self->wait_fn = ready;
+        self->wait_arg = arg;
+        self->state = CO_WAITING;
+        co_switch(&self->sp, co_host_sp);
+        return;
+    }
+
+    // Plain thread: keep coroutines going, and when none of them can make
+    // progress sleep a tick so every lower priority thread (and the idle
+    // thread's WFI) gets the CPU instead of a spin
+    while (!ready(arg)) {
+        if (co_pump() == 0 && thread_current()) thread_sleep_ms(1);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+/*
+ * Stackful Coroutines for Spark
+ *
+ * Cheap cooperative tasks with small private stacks. The stacks sit
+ * back to back without guard pages; the pump checks a canary at the
+ * bottom of each one and retires a coroutine that has run past it. A coroutine only
+ * gives up the CPU in co_yield() or co_await_io(), so code between those
+ * calls needs no locking against other coroutines. Drivers yield inside
+ * their blocking calls, though: state that must stay consistent across
+ * them needs a claim (sd_claim, fat32_claim).
+ *
+ * Coroutines have no thread of their own: whichever thread calls
+ * co_yield() outside a coroutine runs every ready coroutine once before
+ * returning. Blocking loops (input, SD busy waits) call co_await_io(),
+ * which does this for them while they wait.
+ */
+
+#include <package.h>
+
+#define CO_MAX              16
+#define CO_STACK_SIZE       4096    // FAT calls nest deep, plus IRQ frames
+#define CO_STACK_CANARY     0xC0C0FEEDu // Lowest word of every stack
+#define CO_NAME_LEN         16
+
+typedef enum {
+    CO_FREE,
+    CO_READY,
+    CO_WAITING,                 // Until wait_fn(wait_arg) returns non-zero
+    CO_DEAD                     // Returned, slot reclaimed by the next pump
+} co_state_t;
+
+typedef int (*co_ready_fn)(void *arg);
+typedef void (*co_entry_t)(void *arg);
+
+typedef struct {
+    u32 *sp;                    // Saved stack pointer while switched out
+    co_state_t state;
+    co_ready_fn wait_fn;
+    void *wait_arg;
+    u32 switches;               // Times resumed
+    char name[CO_NAME_LEN];
+} co_t;
+
+// Start a coroutine; returns 0 if every slot is taken
+co_t *co_spawn(const char *name, co_entry_t entry, void *arg);
+
+// Inside a coroutine: let the others run. Outside: run each ready one once.
+void co_yield(void);
+
+// Wait until ready(arg) is non-zero, running other coroutines meanwhile
+void co_await_io(co_ready_fn ready, void *arg);
+
+// Coroutine currently executing on this thread (0 if none)
+co_t *co_self(void);
+
+// Number of coroutines that have not finished
+int co_active(void);
+
+// Slot index 0..CO_MAX-1, 0 if unused
+co_t *co_get(int index);
+
+// Low-level switch and entry (sys/entry.s)
+void co_switch(u32 **save_sp, u32 *load_sp);
+void co_trampoline(void);
+void co_exit(void);
+
+#endif
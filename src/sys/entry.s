@@ -0,0 +1,121 @@
+/*
+ * entry.s - Exception vectors, IRQ entry, thread and coroutine switches
+ *
+ * All kernel code runs in SVC mode. The IRQ handler only borrows the IRQ
+ * stack for three words, then moves to SVC mode and saves the interrupted
+ * context on the current thread's stack as an irq_frame_t:
+ *
+ *   [spsr, r0-r12, lr, pc]
+ *
+ * irq_handler() may switch threads before returning, in which case the
+ * frame stays on the old thread's stack until it is scheduled again.
+ */
+
+.section .text
+
+@ ----------------------------------------------------------------------------
+@ Vector table (copied to 0x0 by boot.s)
+@ ----------------------------------------------------------------------------
+
+.global vectors_start
+.global vectors_end
+vectors_start:
+    ldr pc, vec_reset
+    ldr pc, vec_undef
+    ldr pc, vec_swi
+    ldr pc, vec_pabort
+    ldr pc, vec_dabort
+    nop
+    ldr pc, vec_irq
+    ldr pc, vec_fiq
+vec_reset:  .word _start
+vec_undef:  .word exc_hang
+vec_swi:    .word exc_hang
+vec_pabort: .word exc_hang
+vec_dabort: .word exc_hang
+vec_irq:    .word irq_entry
+vec_fiq:    .word exc_hang
+vectors_end:
+
+@ Unexpected exception: stop here so a debugger shows where we came from
+exc_hang:
+    b exc_hang
+
+@ ----------------------------------------------------------------------------
+@ IRQ entry
+@ ----------------------------------------------------------------------------
+
+irq_entry:
+    sub     lr, lr, #4              @ Return address
+    stmfd   sp!, {r0-r2}            @ Scratch on the IRQ stack
+    mov     r0, sp
+    mov     r1, lr
+    mrs     r2, spsr
+    add     sp, sp, #12             @ IRQ stack is empty again
+
+    msr     cpsr_c, #0xD3           @ SVC mode, IRQ and FIQ masked
+
+    stmfd   sp!, {r1}               @ pc
+    stmfd   sp!, {lr}               @ lr_svc
+    stmfd   sp!, {r3-r12}
+    ldmia   r0, {r3-r5}             @ Interrupted r0-r2
+    stmfd   sp!, {r3-r5}
+    stmfd   sp!, {r2}               @ spsr
+
+    mov     r0, sp                  @ irq_frame_t *
+    mov     r4, sp
+    bic     sp, sp, #7              @ AAPCS stack alignment
+    bl      irq_handler
+    mov     sp, r4
+
+    ldmfd   sp!, {r0}
+    msr     spsr_cxsf, r0
+    ldmfd   sp!, {r0-r12, lr}
+    ldmfd   sp!, {pc}^              @ Return and restore CPSR
+
+@ ----------------------------------------------------------------------------
+@ void ctx_switch(u32 **save_sp, u32 *load_sp)
+@ Called with IRQs disabled. Saves callee-saved registers on the current
+@ stack, stores sp in *save_sp and resumes the thread whose sp is load_sp.
+@ ----------------------------------------------------------------------------
+
+.global ctx_switch
+ctx_switch:
+    stmfd   sp!, {r4-r11, lr}
+    str     sp, [r0]
+    mov     sp, r1
+    ldmfd   sp!, {r4-r11, pc}
+
+@ ----------------------------------------------------------------------------
+@ First code run by a new thread: r4 = entry, r5 = arg
+@ ----------------------------------------------------------------------------
+
+.global thread_trampoline
+thread_trampoline:
+    msr     cpsr_c, #0x13           @ SVC mode, IRQs enabled
+    mov     r0, r5
+    blx     r4
+    bl      thread_exit
+
+@ ----------------------------------------------------------------------------
+@ void co_switch(u32 **save_sp, u32 *load_sp)
+@ Same frame as ctx_switch, but runs with IRQs in whatever state the caller
+@ has: coroutines only switch among themselves inside one thread.
+@ ----------------------------------------------------------------------------
+
+.global co_switch
+co_switch:
+    stmfd   sp!, {r4-r11, lr}
+    str     sp, [r0]
+    mov     sp, r1
+    ldmfd   sp!, {r4-r11, pc}
+
+@ ----------------------------------------------------------------------------
+@ First code run by a new coroutine: r4 = entry, r5 = arg
+@ ----------------------------------------------------------------------------
+
+.global co_trampoline
+co_trampoline:
+    mov     r0, r5
+    blx     r4
+    bl      co_exit
@@ -0,0 +1,30 @@
+/*
+ * Boot-time memory allocator
+ */
+
+#include "heap.h"
+#include "irq.h"
+
+static u32 heap_next = 0;
+static u32 heap_end = 0;
+
+void heap_init(u32 start, u32 end) {
+    heap_next = start;
+    heap_end = end > start ? end : start;
+}
+
+void *kalloc(u32 size, u32 align) {
+    u32 flags = irq_save();
+    u32 p = (heap_next + align - 1) & ~(align - 1);
+    if (p < heap_next || p > heap_end || size > heap_end - p) {
+        irq_restore(flags);
+        return 0;
+    }
+    heap_next = p + size;
+    irq_restore(flags);
+    return (void *)p;
+}
+
+u32 heap_free(void) {
+    return heap_end - heap_next;
+}
@@ -0,0 +1,21 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+/*
+ * Boot-time memory allocator
+ *
+ * Everything between the end of the kernel image and the top of RAM is
+ * handed out by a bump pointer. Allocations last until reset; this is for
+ * buffers sized once at boot (framebuffer, caches), not for churn.
+ */
+
+#include <package.h>
+
+void heap_init(u32 start, u32 end);
+
+// Returns 0 when the heap cannot fit size bytes; align is a power of two
+void *kalloc(u32 size, u32 align);
+
+u32 heap_free(void);
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * System status row
+ */
+
+#include "hud.h"
+#include "heap.h"
+#include "irq.h"
+#include "thread.h"
+#include "tick.h"
+#include <drivers/fat32Driver.h>
+#include <drivers/graphicsDriver.h>
+#include <drivers/pl181_sd.h>
+
+#if CONFIG_GRAPHICS && CONFIG_HUD
+
+// Counter values at the last sample
+typedef struct {
+    u32 ticks;
+    u32 idle_ticks;
+    u32 sd_read;
+    u32 sd_written;
+    u32 cache_hits;
+    u32 cache_misses;
+    u32 irqs;
+} hud_sample_t;
+
+static thread_t *hud_idle = 0;
+
+static void hud_take(hud_sample_t *s) {
+    s->ticks = ticks;
+    s->idle_ticks = hud_idle ? hud_idle->run_ticks : 0;
+    sd_get_stats(&s->sd_read, &s->sd_written);
+    fat32_cache_stats(&s->cache_hits, &s->cache_misses);
+    s->irqs = irq_count;
+}
+
+// Format the rates between two samples into a status line
+static void hud_format(char *buf, size_t size, const hud_sample_t *a,
+                       const hud_sample_t *b) {
+    u32 dt = b->ticks - a->ticks;
+    if (dt == 0) dt = 1;
+
+    u32 idle = (b->idle_ticks - a->idle_ticks) * 100 / dt;
+    if (idle > 100) idle = 100;
+
+    // Sectors are 512 bytes, so sectors * TICK_HZ / 2 / dt is KB/s
+    u32 rd = (b->sd_read - a->sd_read) * TICK_HZ / 2 / dt;
+    u32 wr = (b->sd_written - a->sd_written) * TICK_HZ / 2 / dt;
+    u32 irqs = (b->irqs - a->irqs) * TICK_HZ / dt;
+
+    u32 hits = b->cache_hits - a->cache_hits;
+    u32 lookups = hits + (b->cache_misses - a->cache_misses);
+    char cache[8];
+    if (lookups) {
+        ksnprintf(cache, sizeof(cache), "%3u%%", hits * 100 / lookups);
+    } else {
+        ksnprintf(cache, sizeof(cache), "  --");
+    }
+
+    ksnprintf(buf, size,
+              " idle %3u%%  sd r %4u w %4u KB/s  cache %s  irq %4u/s  free %u KB",
+              idle, rd, wr, cache, irqs, heap_free() / 1024);
+}
+
+static void hud_thread(void *arg) {
+    (void)arg;
+    hud_sample_t prev, now;
+    char line[SCREEN_COLS + 1];
+
+    hud_take(&prev);
+    while (1) {
+        thread_sleep_ms(HUD_PERIOD_MS);
+        hud_take(&now);
+        hud_format(line, sizeof(line), &prev, &now);
+        gfx_status_write(line);
+        prev = now;
+    }
+}
+
+void hud_start(void) {
+    for (int i = 0; i < THREAD_MAX; i++) {
+        thread_t *t = thread_get(i);
+        if (t && strcmp(t->name, "idle") == 0) hud_idle = t;
+    }
+
+    gfx_status_enable(COLOR_BLACK, COLOR_GRAY);
+    gfx_status_write(" collecting...");
+    thread_create("hud", hud_thread, 0, THREAD_PRIO_LOW);
+}
+
+#else
+
+void hud_start(void) {
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef HUD_H
+#define HUD_H
+
+/*
+ * System status row
+ *
+ * A low priority thread samples the kernel counters once a second and
+ * shows the rates on the bottom row of the screen: CPU idle time, SD
+ * throughput, FAT cache hit rate, interrupt rate and free memory. All the
+ * work happens in that thread; the drivers only bump their counters.
+ */
+
+#include <package.h>
+
+#define HUD_PERIOD_MS       1000
+
+// Reserve the status row and start sampling (needs the graphics console)
+void hud_start(void);
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Interrupt dispatch for the PL190 VIC
+ */
+
+#include "irq.h"
+#include "thread.h"
+
+volatile u32 irq_count = 0;
+volatile int irq_nesting = 0;
+
+static irq_handler_t irq_handlers[IRQ_LINES];
+static irq_handler_t sic_handlers[IRQ_LINES];
+
+// Mask every source and route them all to IRQ
+void irq_init(void) {
+    *VIC_INTENCLEAR = 0xFFFFFFFF;
+    *VIC_INTSELECT = 0;
+    *VIC_SOFTINTCLEAR = 0xFFFFFFFF;
+
+    *SIC_ENCLR = 0xFFFFFFFF;
+    *SIC_PICENCLR = 0xFFFFFFFF;     // Everything goes through line 31
+
+    for (int i = 0; i < IRQ_LINES; i++) {
+        irq_handlers[i] = 0;
+        sic_handlers[i] = 0;
+    }
+}
+
+// Dispatch the pending secondary sources (VIC line 31)
+static void sic_dispatch(void) {
+    u32 status = *SIC_STATUS;
+    while (status) {
+        u32 line = 31 - __builtin_clz(status);
+        status &= ~(1u << line);
+
+        if (sic_handlers[line]) {
+            sic_handlers[line]();
+        } else {
+            *SIC_ENCLR = 1u << line;
+        }
+    }
+}
+
+// Install a handler for a VIC line and unmask it
+void irq_register(u32 line, irq_handler_t handler) {
+    if (line >= IRQ_LINES) return;
+
+    u32 flags = irq_save();
+    irq_handlers[line] = handler;
+    *VIC_INTENABLE = 1u << line;
+    irq_restore(flags);
+}
+
+// Mask a VIC line and drop its handler
+void irq_unregister(u32 line) {
+    if (line >= IRQ_LINES) return;
+
+    u32 flags = irq_save();
+    *VIC_INTENCLEAR = 1u << line;
+    irq_handlers[line] = 0;
+    irq_restore(flags);
+}
+
+// Install a handler for a secondary line and unmask it
+void irq_register_sic(u32 line, irq_handler_t handler) {
+    if (line >= IRQ_LINES) return;
+
+    u32 flags = irq_save();
+    sic_handlers[line] = handler;
+    *SIC_ENSET = 1u << line;
+    irq_handlers[IRQ_SIC] = sic_dispatch;
+    *VIC_INTENABLE = 1u << IRQ_SIC;
+    irq_restore(flags);
+}
+
+// Dispatch every pending source, then let the scheduler switch threads
+void irq_handler(irq_frame_t *frame) {
+    (void)frame;
+    irq_count++;
+    irq_nesting++;
+
+    u32 status = *VIC_IRQSTATUS;
+    while (status) {
+        u32 line = 31 - __builtin_clz(status);
+        status &= ~(1u << line);
+
+        if (irq_handlers[line]) {
+            irq_handlers[line]();
+        } else {
+            *VIC_INTENCLEAR = 1u << line;  // Spurious source, keep it quiet
+        }
+    }
+
+    irq_nesting--;
+    thread_irq_exit();
+}
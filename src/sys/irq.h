@@ -0,0 +1,104 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+/*
+ * PL190 Vectored Interrupt Controller for VersatilePB
+ *
+ * All sources are routed to IRQ (never FIQ) and dispatched in software
+ * from irq_handler(), which runs in SVC mode on the interrupted thread's
+ * stack (see sys/entry.s). Sources behind the secondary controller (SIC)
+ * arrive on VIC line 31 and are dispatched from a second table.
+ */
+
+#include <package.h>
+
+// PL190 VIC base address on VersatilePB
+#define VIC_BASE            0x10140000
+
+#define VIC_IRQSTATUS       ((volatile u32 *)(VIC_BASE + 0x00))
+#define VIC_RAWINTR         ((volatile u32 *)(VIC_BASE + 0x08))
+#define VIC_INTSELECT       ((volatile u32 *)(VIC_BASE + 0x0C))
+#define VIC_INTENABLE       ((volatile u32 *)(VIC_BASE + 0x10))
+#define VIC_INTENCLEAR      ((volatile u32 *)(VIC_BASE + 0x14))
+#define VIC_SOFTINT         ((volatile u32 *)(VIC_BASE + 0x18))
+#define VIC_SOFTINTCLEAR    ((volatile u32 *)(VIC_BASE + 0x1C))
+
+// Primary interrupt lines
+#define IRQ_TIMER01         4
+#define IRQ_TIMER23         5
+#define IRQ_UART0           12
+#define IRQ_CLCD            16
+#define IRQ_SIC             31       // Secondary controller (KMI, MMCI, ...)
+
+#define IRQ_LINES           32
+
+// Secondary interrupt controller (SIC) on VIC line 31
+#define SIC_BASE            0x10003000
+
+#define SIC_STATUS          ((volatile u32 *)(SIC_BASE + 0x00))
+#define SIC_ENSET           ((volatile u32 *)(SIC_BASE + 0x08))
+#define SIC_ENCLR           ((volatile u32 *)(SIC_BASE + 0x0C))
+#define SIC_PICENCLR        ((volatile u32 *)(SIC_BASE + 0x24))
+
+// Secondary interrupt lines
+#define SIC_KMI0            3
+#define SIC_KMI1            4
+
+// CPSR interrupt mask bits
+#define CPSR_IRQ_DISABLE    (1 << 7)
+#define CPSR_FIQ_DISABLE    (1 << 6)
+
+typedef void (*irq_handler_t)(void);
+
+// Register layout pushed by the IRQ entry code
+typedef struct {
+    u32 spsr;
+    u32 r[13];
+    u32 lr;
+    u32 pc;
+} irq_frame_t;
+
+// Interrupts taken since boot
+extern volatile u32 irq_count;
+
+// Non-zero while dispatching device handlers
+extern volatile int irq_nesting;
+
+void irq_init(void);
+void irq_register(u32 line, irq_handler_t handler);
+void irq_unregister(u32 line);
+void irq_register_sic(u32 line, irq_handler_t handler);
+
+// Called from the IRQ entry code with interrupts disabled
+void irq_handler(irq_frame_t *frame);
+
+// Enable IRQs on the CPU
+static inline void irq_enable(void) {
+    u32 cpsr;
+    __asm__ volatile("mrs %0, cpsr" : "=r"(cpsr));
+    cpsr &= ~CPSR_IRQ_DISABLE;
+    __asm__ volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
+}
+
+// Disable IRQs on the CPU
+static inline void irq_disable(void) {
+    u32 cpsr;
+    __asm__ volatile("mrs %0, cpsr" : "=r"(cpsr));
+    cpsr |= CPSR_IRQ_DISABLE;
+    __asm__ volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
+}
+
+// Disable IRQs and return the previous state for irq_restore()
+static inline u32 irq_save(void) {
+    u32 cpsr;
+    __asm__ volatile("mrs %0, cpsr" : "=r"(cpsr));
+    __asm__ volatile("msr cpsr_c, %0" : : "r"(cpsr | CPSR_IRQ_DISABLE) : "memory");
+    return cpsr;
+}
+
+// Restore the IRQ state saved by irq_save()
+static inline void irq_restore(u32 flags) {
+    __asm__ volatile("msr cpsr_c, %0" : : "r"(flags) : "memory");
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Kernel log ring
+ */
+
+#include "klog.h"
+#include "irq.h"
+#include "tick.h"
+
+static char klog_ring[KLOG_SIZE];
+static u32 klog_head = 0;          // Total bytes ever written
+
+static void klog_sink(void *ctx, const char *s, size_t n) {
+    (void)ctx;
+    while (n > 0) {
+        u32 offset = klog_head & (KLOG_SIZE - 1);
+        u32 chunk = KLOG_SIZE - offset;
+        if (chunk > n) chunk = n;
+
+        memcpy(&klog_ring[offset], s, chunk);
+        klog_head += chunk;
+        s += chunk;
+        n -= chunk;
+    }
+}
+
+// Log a line; a trailing newline is added if the message has none
+void klog(const char *fmt, ...) {
+    u32 flags = irq_save();
+
+    u32 t = ticks;
+    char stamp[24];
+    int n = ksnprintf(stamp, sizeof(stamp), "[%5u.%02u] ",
+                      t / TICK_HZ, (t % TICK_HZ) * 100 / TICK_HZ);
+    klog_sink(0, stamp, n);
+
+    va_list ap;
+    va_start(ap, fmt);
+    kvformat(klog_sink, 0, fmt, ap);
+    va_end(ap);
+
+    if (klog_ring[(klog_head - 1) & (KLOG_SIZE - 1)] != '\n') {
+        klog_sink(0, "\n", 1);
+    }
+
+    irq_restore(flags);
+}
+
+void klog_dump(fmt_sink_t sink, void *ctx) {
+    u32 flags = irq_save();
+    u32 head = klog_head;
+    irq_restore(flags);
+
+    if (head <= KLOG_SIZE) {
+        sink(ctx, klog_ring, head);
+        return;
+    }
+
+    // Wrapped: skip the partial oldest line
+    u32 start = head & (KLOG_SIZE - 1);
+    u32 skip = 0;
+    while (skip < KLOG_SIZE && klog_ring[(start + skip) & (KLOG_SIZE - 1)] != '\n') {
+        skip++;
+    }
+    start = (start + skip + 1) & (KLOG_SIZE - 1);
+    u32 end = head & (KLOG_SIZE - 1);
+
+    if (start <= end) {
+        sink(ctx, &klog_ring[start], end - start);
+    } else {
+        sink(ctx, &klog_ring[start], KLOG_SIZE - start);
+        sink(ctx, klog_ring, end);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef KLOG_H
+#define KLOG_H
+
+/*
+ * Kernel log
+ *
+ * klog() formats a message with the same engine as kprintf and appends it
+ * to a fixed ring, prefixed with the uptime. When the ring is full the
+ * oldest lines are overwritten. `dmesg` prints the ring.
+ */
+
+#include <package.h>
+
+#define KLOG_SIZE       CONFIG_KLOG_SIZE    // Power of two
+
+void klog(const char *fmt, ...);
+
+// Pass the log, oldest first, to a sink in at most two spans
+void klog_dump(fmt_sink_t sink, void *ctx);
+
+#endif
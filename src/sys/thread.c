@@ -0,0 +1,304 @@
+/*
+ * Kernel Threads - priority round-robin scheduler
+ */
+
+#include "thread.h"
+#include "irq.h"
+#include "tick.h"
+
+static thread_t threads[THREAD_MAX];
+static u8 thread_stacks[THREAD_MAX][THREAD_STACK_SIZE] __attribute__((aligned(8)));
+
+static thread_t *current = 0;
+static thread_t *run_head[THREAD_PRIO_LEVELS];
+static thread_t *run_tail[THREAD_PRIO_LEVELS];
+static volatile int need_resched = 0;
+static u32 next_id = 0;
+
+// ============================================================================
+// Run Queues (IRQs must be disabled)
+// ============================================================================
+
+// Append a thread to the back of its priority's run queue
+static void runq_push(thread_t *t) {
+    t->state = THREAD_READY;
+    t->next = 0;
+    if (run_tail[t->priority]) {
+        run_tail[t->priority]->next = t;
+    } else {
+        run_head[t->priority] = t;
+    }
+    run_tail[t->priority] = t;
+
+    if (current && t->priority < current->priority) {
+        need_resched = 1;
+    }
+}
+
+// Take the first thread of the highest non-empty priority
+static thread_t *runq_pop(void) {
+    for (int p = 0; p < THREAD_PRIO_LEVELS; p++) {
+        thread_t *t = run_head[p];
+        if (t) {
+            run_head[p] = t->next;
+            if (!run_head[p]) run_tail[p] = 0;
+            t->next = 0;
+            return t;
+        }
+    }
+    return 0;
+}
+
+// Pick the next thread and switch to it
+// The idle thread is always runnable, so there is always something to pick.
+static void schedule(void) {
+    thread_t *prev = current;
+
+    if (prev->state == THREAD_RUNNING) {
+        runq_push(prev);
+    }
+
+    thread_t *next = runq_pop();
+    need_resched = 0;
+
+    next->state = THREAD_RUNNING;
+    next->slice = THREAD_TIMESLICE;
+    if (next == prev) return;
+
+    current = next;
+    ctx_switch(&prev->sp, next->sp);
+}
+
+// Make a waiting thread runnable and preempt now if it outranks us
+static void thread_make_ready(thread_t *t) {
+    runq_push(t);
+    if (need_resched && !irq_nesting) {
+        schedule();
+    }
+}
+
+// ============================================================================
+// Idle Thread
+// ============================================================================
+
+static void idle_entry(void *arg) {
+    (void)arg;
+    while (1) {
+        // ARM926 wait-for-interrupt (CP15 c7, c0, 4)
+        __asm__ volatile("mcr p15, 0, %0, c7, c0, 4" : : "r"(0) : "memory");
+    }
+}
+
+// ============================================================================
+// Thread API
+// ============================================================================
+
+static void thread_set_name(thread_t *t, const char *name) {
+    int i = 0;
+    while (name[i] && i < THREAD_NAME_LEN - 1) {
+        t->name[i] = name[i];
+        i++;
+    }
+    t->name[i] = '\0';
+}
+
+// Turn the boot flow into the "main" thread, start the idle thread and tick
+void thread_init(void) {
+    memset(threads, 0, sizeof(threads));
+
+    thread_t *boot = &threads[0];
+    boot->id = next_id++;
+    boot->state = THREAD_RUNNING;
+    boot->priority = THREAD_PRIO_NORMAL;
+    boot->slice = THREAD_TIMESLICE;
+    boot->stack = 0;  // Keeps running on the boot stack
+    thread_set_name(boot, "main");
+    current = boot;
+
+    thread_create("idle", idle_entry, 0, THREAD_PRIO_IDLE);
+
+    tick_init();
+    irq_enable();
+}
+
+// Create a thread; it starts running entry(arg) when first scheduled
+// Returns 0 if every slot is taken
+thread_t *thread_create(const char *name, thread_entry_t entry, void *arg, int priority) {
+    if (priority < 0 || priority >= THREAD_PRIO_LEVELS) return 0;
+
+    u32 flags = irq_save();
+
+    // Exited threads can be reused once they are no longer running
+    thread_t *t = 0;
+    int slot;
+    for (slot = 1; slot < THREAD_MAX; slot++) {
+        thread_state_t s = threads[slot].state;
+        if (s == THREAD_UNUSED || (s == THREAD_ZOMBIE && &threads[slot] != current)) {
+            t = &threads[slot];
+            break;
+        }
+    }
+    if (!t) {
+        irq_restore(flags);
+        return 0;
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->id = next_id++;
+    t->priority = priority;
+    t->stack = thread_stacks[slot];
+    thread_set_name(t, name);
+
+    // Initial frame popped by ctx_switch: r4-r11, then lr
+    u32 *sp = (u32 *)(t->stack + THREAD_STACK_SIZE);
+    *--sp = (u32)thread_trampoline;     // lr
+    for (int r = 11; r >= 4; r--) {
+        *--sp = 0;
+    }
+    sp[0] = (u32)entry;                 // r4
+    sp[1] = (u32)arg;                   // r5
+    t->sp = sp;
+
+    thread_make_ready(t);
+    irq_restore(flags);
+    return t;
+}
+
+// Terminate the calling thread (also reached by returning from its entry)
+void thread_exit(void) {
+    irq_disable();
+    current->state = THREAD_ZOMBIE;
+    schedule();
+
+    while (1);  // Not reached
+}
+
+thread_t *thread_current(void) {
+    return current;
+}
+
+thread_t *thread_get(int index) {
+    if (index < 0 || index >= THREAD_MAX) return 0;
+    if (threads[index].state == THREAD_UNUSED) return 0;
+    return &threads[index];
+}
+
+// Give the rest of the time slice to other ready threads
+void thread_yield(void) {
+    u32 flags = irq_save();
+    schedule();
+    irq_restore(flags);
+}
+
+// Block the calling thread for at least ms milliseconds
+void thread_sleep_ms(u32 ms) {
+    u32 wait = tick_from_ms(ms);
+    if (wait == 0) wait = 1;
+
+    u32 flags = irq_save();
+    current->wake_tick = ticks + wait;
+    current->state = THREAD_SLEEPING;
+    schedule();
+    irq_restore(flags);
+}
+
+// ============================================================================
+// Wait Queues
+// ============================================================================
+
+void wait_queue_init(wait_queue_t *wq) {
+    wq->head = 0;
+    wq->tail = 0;
+}
+
+// Block on a wait queue until woken (IRQs disabled by the caller)
+void thread_wait(wait_queue_t *wq) {
+    current->state = THREAD_BLOCKED;
+    current->next = 0;
+    if (wq->tail) {
+        wq->tail->next = current;
+    } else {
+        wq->head = current;
+    }
+    wq->tail = current;
+
+    schedule();
+}
+
+// Wake the longest waiting thread
+void thread_wake_one(wait_queue_t *wq) {
+    u32 flags = irq_save();
+    thread_t *t = wq->head;
+    if (t) {
+        wq->head = t->next;
+        if (!wq->head) wq->tail = 0;
+        thread_make_ready(t);
+    }
+    irq_restore(flags);
+}
+
+// Wake every waiting thread
+void thread_wake_all(wait_queue_t *wq) {
+    u32 flags = irq_save();
+    thread_t *t = wq->head;
+    wq->head = 0;
+    wq->tail = 0;
+    while (t) {
+        thread_t *next = t->next;
+        runq_push(t);
+        t = next;
+    }
+    if (need_resched && !irq_nesting) {
+        schedule();
+    }
+    irq_restore(flags);
+}
+
+// ============================================================================
+// Mutexes
+// ============================================================================
+
+void mutex_lock(mutex_t *m) {
+    u32 flags = irq_save();
+    while (m->owner) {
+        thread_wait(&m->wq);
+    }
+    m->owner = current;
+    irq_restore(flags);
+}
+
+void mutex_unlock(mutex_t *m) {
+    u32 flags = irq_save();
+    m->owner = 0;
+    thread_wake_one(&m->wq);
+    irq_restore(flags);
+}
+
+// ============================================================================
+// Scheduler Hooks
+// ============================================================================
+
+// Timer tick (IRQ context): account time, wake sleepers, end time slices
+void thread_tick(void) {
+    if (!current) return;
+
+    current->run_ticks++;
+
+    for (int i = 0; i < THREAD_MAX; i++) {
+        thread_t *t = &threads[i];
+        if (t->state == THREAD_SLEEPING && (i32)(ticks - t->wake_tick) >= 0) {
+            runq_push(t);
+        }
+    }
+
+    if (--current->slice <= 0) {
+        need_resched = 1;
+    }
+}
+
+// Last step of every interrupt: switch threads if the tick or a wakeup asked
+void thread_irq_exit(void) {
+    if (current && need_resched) {
+        schedule();
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+/*
+ * Kernel Threads for Spark
+ *
+ * Preemptive priority round-robin scheduling on a single core. Each
+ * thread has its own SVC-mode stack; the timer tick charges the running
+ * thread and forces a switch when its time slice runs out or a higher
+ * priority thread becomes ready. Threads block on wait queues or sleep
+ * for a number of milliseconds.
+ *
+ * kernel_main becomes the "main" thread when thread_init() is called.
+ */
+
+#include <package.h>
+
+#define THREAD_MAX          16
+#define THREAD_STACK_SIZE   8192
+#define THREAD_NAME_LEN     16
+
+// Ticks a thread may run before others of the same priority get a turn
+#define THREAD_TIMESLICE    5
+
+// Priorities (lower value runs first)
+#define THREAD_PRIO_HIGH    0
+#define THREAD_PRIO_NORMAL  1
+#define THREAD_PRIO_LOW     2
+#define THREAD_PRIO_IDLE    3
+#define THREAD_PRIO_LEVELS  4
+
+typedef enum {
+    THREAD_UNUSED,
+    THREAD_READY,
+    THREAD_RUNNING,
+    THREAD_BLOCKED,             // On a wait queue
+    THREAD_SLEEPING,            // Until wake_tick
+    THREAD_ZOMBIE               // Exited, stack still in use
+} thread_state_t;
+
+typedef struct thread {
+    u32 *sp;                    // Saved stack pointer while switched out
+    u32 id;
+    thread_state_t state;
+    int priority;
+    int slice;                  // Ticks left in the current time slice
+    u32 wake_tick;              // Tick at which a sleeping thread wakes
+    u32 run_ticks;              // Ticks spent running
+    struct thread *next;        // Run queue or wait queue link
+    u8 *stack;                  // Stack base (0 for the boot stack)
+    char name[THREAD_NAME_LEN];
+} thread_t;
+
+typedef struct {
+    thread_t *head;
+    thread_t *tail;
+} wait_queue_t;
+
+#define WAIT_QUEUE_INIT     { 0, 0 }
+
+// Sleeping lock for sections too long to run with IRQs disabled
+typedef struct {
+    thread_t *owner;
+    wait_queue_t wq;
+} mutex_t;
+
+#define MUTEX_INIT          { 0, WAIT_QUEUE_INIT }
+
+typedef void (*thread_entry_t)(void *arg);
+
+// Setup
+void thread_init(void);
+
+// Thread lifecycle
+thread_t *thread_create(const char *name, thread_entry_t entry, void *arg, int priority);
+void thread_exit(void);
+thread_t *thread_current(void);
+thread_t *thread_get(int index);    // Slot index 0..THREAD_MAX-1, 0 if unused
+
+// Giving up the CPU
+void thread_yield(void);
+void thread_sleep_ms(u32 ms);
+
+// Wait queues
+// thread_wait() must be called with IRQs disabled (irq_save) after checking
+// the condition being waited for, and returns with IRQs still disabled.
+void wait_queue_init(wait_queue_t *wq);
+void thread_wait(wait_queue_t *wq);
+void thread_wake_one(wait_queue_t *wq);
+void thread_wake_all(wait_queue_t *wq);
+
+// Mutexes (not recursive; thread context only)
+void mutex_lock(mutex_t *m);
+void mutex_unlock(mutex_t *m);
+
+// Scheduler hooks (tick and IRQ exit)
+void thread_tick(void);
+void thread_irq_exit(void);
+
+// Low-level switch (sys/entry.s)
+void ctx_switch(u32 **save_sp, u32 *load_sp);
+void thread_trampoline(void);
+
+#endif
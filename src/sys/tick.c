@@ -0,0 +1,29 @@
+/*
+ * SP804 periodic tick
+ */
+
+#include "tick.h"
+#include "irq.h"
+#include "thread.h"
+
+volatile u32 ticks = 0;
+
+static void tick_irq(void) {
+    if (!(*TIMER0_MIS & 1)) return;  // Timer1 shares the line
+    *TIMER0_INTCLR = 1;
+
+    ticks++;
+    thread_tick();
+}
+
+// Start Timer0 in periodic mode at TICK_HZ
+void tick_init(void) {
+    *TIMER0_CONTROL = 0;
+    *TIMER0_LOAD = TIMER_CLOCK_HZ / TICK_HZ;
+    *TIMER0_INTCLR = 1;
+
+    irq_register(IRQ_TIMER01, tick_irq);
+
+    *TIMER0_CONTROL = TIMER_CTRL_ENABLE | TIMER_CTRL_PERIODIC |
+                      TIMER_CTRL_INTEN | TIMER_CTRL_32BIT;
+}
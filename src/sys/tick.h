@@ -0,0 +1,42 @@
+#ifndef TICK_H
+#define TICK_H
+
+/*
+ * Scheduler tick from SP804 Timer0 on VersatilePB
+ */
+
+#include <package.h>
+
+// SP804 dual timer (Timer0/1) base address
+#define SP804_BASE          0x101E2000
+
+#define TIMER0_LOAD         ((volatile u32 *)(SP804_BASE + 0x00))
+#define TIMER0_VALUE        ((volatile u32 *)(SP804_BASE + 0x04))
+#define TIMER0_CONTROL      ((volatile u32 *)(SP804_BASE + 0x08))
+#define TIMER0_INTCLR       ((volatile u32 *)(SP804_BASE + 0x0C))
+#define TIMER0_MIS          ((volatile u32 *)(SP804_BASE + 0x14))
+
+// Control register bits
+#define TIMER_CTRL_32BIT    (1 << 1)
+#define TIMER_CTRL_INTEN    (1 << 5)
+#define TIMER_CTRL_PERIODIC (1 << 6)
+#define TIMER_CTRL_ENABLE   (1 << 7)
+
+// TIMCLK on VersatilePB is 1 MHz
+#define TIMER_CLOCK_HZ      1000000
+
+// Scheduler tick rate
+#define TICK_HZ             100
+#define TICK_MS             (1000 / TICK_HZ)
+
+// Ticks since tick_init()
+extern volatile u32 ticks;
+
+void tick_init(void);
+
+// Convert milliseconds to ticks, rounding up
+static inline u32 tick_from_ms(u32 ms) {
+    return (ms + TICK_MS - 1) / TICK_MS;
+}
+
+#endif